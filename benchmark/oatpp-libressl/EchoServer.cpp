@@ -0,0 +1,106 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "EchoServer.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+EchoServer::EchoServer(const std::shared_ptr<oatpp::network::ServerConnectionProvider>& provider)
+  : m_provider(provider)
+  , m_running(false)
+  , m_connectionThreads(0)
+{}
+
+EchoServer::~EchoServer() {
+  /* accept thread uses `this` - it has to be joined by stop() */
+  OATPP_ASSERT(!m_acceptThread.joinable());
+}
+
+void EchoServer::echo(const std::shared_ptr<oatpp::data::stream::IOStream>& connection) {
+  v_char8 buffer[16 * 1024];
+  while(true) {
+    auto readCount = connection->read(buffer, sizeof(buffer));
+    if(readCount == oatpp::data::IOError::WAIT_RETRY || readCount == oatpp::data::IOError::RETRY) {
+      continue;
+    }
+    if(readCount <= 0) {
+      return;
+    }
+    data::v_io_size offset = 0;
+    while(offset < readCount) {
+      auto writeCount = connection->write(&buffer[offset], readCount - offset);
+      if(writeCount == oatpp::data::IOError::WAIT_RETRY || writeCount == oatpp::data::IOError::RETRY) {
+        continue;
+      }
+      if(writeCount <= 0) {
+        return;
+      }
+      offset += writeCount;
+    }
+  }
+}
+
+void EchoServer::serve(const std::shared_ptr<oatpp::data::stream::IOStream>& connection) {
+  echo(connection);
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_connectionThreads --;
+  m_condition.notify_all();
+}
+
+void EchoServer::acceptLoop() {
+  while(m_running) {
+    auto connection = m_provider->getConnection();
+    if(!m_running) {
+      break;
+    }
+    if(connection) {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_connectionThreads ++;
+      std::thread(&EchoServer::serve, this, connection).detach();
+    }
+  }
+}
+
+void EchoServer::start() {
+  m_running = true;
+  m_acceptThread = std::thread(&EchoServer::acceptLoop, this);
+}
+
+void EchoServer::stop(const std::shared_ptr<oatpp::network::ClientConnectionProvider>& waker) {
+
+  m_running = false;
+  waker->getConnection();
+  m_acceptThread.join();
+
+  std::unique_lock<std::mutex> lock(m_lock);
+  m_condition.wait(lock, [this]{ return m_connectionThreads == 0; });
+
+  m_provider->close();
+
+}
+
+}}}
@@ -0,0 +1,75 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_EchoServer_hpp
+#define oatpp_benchmark_libressl_EchoServer_hpp
+
+#include "oatpp/network/ConnectionProvider.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Blocking echo server. Accepts connections in a separate thread and echoes each connection in its own thread.
+ * Connection threads are detached so that short-lived connections don't pile up until &l:EchoServer::stop ();.
+ * Started server must be stopped before it is destroyed.
+ */
+class EchoServer {
+private:
+  std::shared_ptr<oatpp::network::ServerConnectionProvider> m_provider;
+  std::atomic<bool> m_running;
+  std::thread m_acceptThread;
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  v_int32 m_connectionThreads;
+private:
+  void acceptLoop();
+  void serve(const std::shared_ptr<oatpp::data::stream::IOStream>& connection);
+  static void echo(const std::shared_ptr<oatpp::data::stream::IOStream>& connection);
+public:
+
+  EchoServer(const std::shared_ptr<oatpp::network::ServerConnectionProvider>& provider);
+  ~EchoServer();
+
+  /**
+   * Start accepting connections.
+   */
+  void start();
+
+  /**
+   * Stop server and join all threads.
+   * @param waker - client provider used to unblock pending `accept()`.
+   */
+  void stop(const std::shared_ptr<oatpp::network::ClientConnectionProvider>& waker);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_EchoServer_hpp */
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Histogram.hpp"
+
+#include <cstdint>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+constexpr v_int32 Histogram::SUB_BUCKET_BITS;
+constexpr v_int32 Histogram::SUB_BUCKETS;
+
+v_int32 Histogram::getBucket(v_int64 value) {
+  if(value < 2 * SUB_BUCKETS) {
+    return (v_int32) value;
+  }
+  v_int32 msb = 63 - __builtin_clzll((unsigned long long) value);
+  v_int32 shift = msb - SUB_BUCKET_BITS;
+  return shift * SUB_BUCKETS + (v_int32) (value >> shift);
+}
+
+v_int64 Histogram::getBucketValue(v_int32 bucket) {
+  if(bucket < 2 * SUB_BUCKETS) {
+    return bucket;
+  }
+  v_int32 shift = bucket / SUB_BUCKETS - 1;
+  v_int64 mantissa = bucket - shift * SUB_BUCKETS;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+Histogram::Histogram()
+  : m_atom(false)
+  , m_buckets(getBucket(INT64_MAX) + 1, 0)
+  , m_count(0)
+  , m_max(0)
+{}
+
+void Histogram::record(v_int64 value) {
+  if(value < 0) {
+    value = 0;
+  }
+  v_int32 bucket = getBucket(value);
+  oatpp::concurrency::SpinLock lock(m_atom);
+  m_buckets[bucket] ++;
+  m_count ++;
+  if(value > m_max) {
+    m_max = value;
+  }
+}
+
+v_int64 Histogram::getCount() {
+  oatpp::concurrency::SpinLock lock(m_atom);
+  return m_count;
+}
+
+v_int64 Histogram::getPercentile(v_float64 percentile) {
+
+  oatpp::concurrency::SpinLock lock(m_atom);
+
+  if(m_count == 0) {
+    return 0;
+  }
+
+  v_int64 rank = (v_int64) (percentile / 100.0 * m_count + 0.5);
+  if(rank < 1) {
+    rank = 1;
+  }
+
+  v_int64 seen = 0;
+  for(v_int32 i = 0; i < (v_int32) m_buckets.size(); i ++) {
+    seen += m_buckets[i];
+    if(seen >= rank) {
+      v_int64 value = getBucketValue(i);
+      return value < m_max ? value : m_max;
+    }
+  }
+
+  return m_max;
+
+}
+
+}}}
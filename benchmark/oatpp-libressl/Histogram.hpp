@@ -0,0 +1,80 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_Histogram_hpp
+#define oatpp_benchmark_libressl_Histogram_hpp
+
+#include "oatpp/core/concurrency/SpinLock.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Thread-safe log-linear histogram of non-negative values (latencies in microseconds).
+ * Values below 64 are exact, larger values are recorded with ~3% precision.
+ * Memory is fixed - recording millions of samples costs nothing extra.
+ */
+class Histogram {
+private:
+  static constexpr v_int32 SUB_BUCKET_BITS = 5;
+  static constexpr v_int32 SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+private:
+  static v_int32 getBucket(v_int64 value);
+  static v_int64 getBucketValue(v_int32 bucket);
+private:
+  oatpp::concurrency::SpinLock::Atom m_atom;
+  std::vector<v_int64> m_buckets;
+  v_int64 m_count;
+  v_int64 m_max;
+public:
+
+  Histogram();
+
+  /**
+   * Record value.
+   * @param value - value. Negative values are recorded as `0`.
+   */
+  void record(v_int64 value);
+
+  /**
+   * Get number of recorded values.
+   * @return - count.
+   */
+  v_int64 getCount();
+
+  /**
+   * Get percentile.
+   * @param percentile - percentile in range `[0, 100]`. Ex.: `99.9`.
+   * @return - upper bound of the bucket the percentile falls in. `0` if nothing recorded.
+   */
+  v_int64 getPercentile(v_float64 percentile);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_Histogram_hpp */
@@ -0,0 +1,123 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "KeyPair.hpp"
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <stdexcept>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+
+  std::string readBio(BIO* bio) {
+    char* data = nullptr;
+    long size = BIO_get_mem_data(bio, &data);
+    return std::string(data, size);
+  }
+
+}
+
+KeyPair KeyPair::generate(const char* commonName) {
+
+  EC_KEY* ecKey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+  if(ecKey == nullptr || EC_KEY_generate_key(ecKey) != 1) {
+    throw std::runtime_error("[oatpp::benchmark::libressl::KeyPair::generate()]: Can't generate EC key");
+  }
+  EC_KEY_set_asn1_flag(ecKey, OPENSSL_EC_NAMED_CURVE);
+
+  EVP_PKEY* pkey = EVP_PKEY_new();
+  EVP_PKEY_assign_EC_KEY(pkey, ecKey);
+
+  X509* x509 = X509_new();
+  X509_set_version(x509, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+  X509_gmtime_adj(X509_get_notBefore(x509), -60);
+  X509_gmtime_adj(X509_get_notAfter(x509), 60 * 60 * 24);
+  X509_set_pubkey(x509, pkey);
+
+  X509_NAME* name = X509_get_subject_name(x509);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*) commonName, -1, -1, 0);
+  X509_set_issuer_name(x509, name);
+
+  if(X509_sign(x509, pkey, EVP_sha256()) == 0) {
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    throw std::runtime_error("[oatpp::benchmark::libressl::KeyPair::generate()]: Can't sign certificate");
+  }
+
+  KeyPair result;
+
+  BIO* certBio = BIO_new(BIO_s_mem());
+  PEM_write_bio_X509(certBio, x509);
+  result.certPem = readBio(certBio);
+  BIO_free(certBio);
+
+  BIO* keyBio = BIO_new(BIO_s_mem());
+  PEM_write_bio_PrivateKey(keyBio, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+  result.keyPem = readBio(keyBio);
+  BIO_free(keyBio);
+
+  X509_free(x509);
+  EVP_PKEY_free(pkey);
+
+  return result;
+
+}
+
+std::shared_ptr<oatpp::libressl::Config> KeyPair::createServerConfig() const {
+
+  auto config = oatpp::libressl::Config::createShared();
+
+  tls_config_set_protocols(config->getTLSConfig(), TLS_PROTOCOLS_ALL);
+
+  if(tls_config_set_ciphers(config->getTLSConfig(), "secure") < 0) {
+    throw std::runtime_error("[oatpp::benchmark::libressl::KeyPair::createServerConfig()]: failed call to tls_config_set_ciphers()");
+  }
+
+  if(tls_config_set_keypair_mem(config->getTLSConfig(),
+                                (const uint8_t*) certPem.data(), certPem.size(),
+                                (const uint8_t*) keyPem.data(), keyPem.size()) < 0)
+  {
+    throw std::runtime_error("[oatpp::benchmark::libressl::KeyPair::createServerConfig()]: failed call to tls_config_set_keypair_mem()");
+  }
+
+  return config;
+
+}
+
+std::shared_ptr<oatpp::libressl::Config> KeyPair::createClientConfig() {
+  auto config = oatpp::libressl::Config::createShared();
+  tls_config_insecure_noverifycert(config->getTLSConfig());
+  tls_config_insecure_noverifyname(config->getTLSConfig());
+  return config;
+}
+
+}}}
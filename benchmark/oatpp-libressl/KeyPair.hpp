@@ -0,0 +1,67 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_KeyPair_hpp
+#define oatpp_benchmark_libressl_KeyPair_hpp
+
+#include "oatpp-libressl/Config.hpp"
+
+#include <string>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Throwaway self-signed certificate and private key generated at runtime (EC P-256).
+ */
+class KeyPair {
+public:
+  std::string certPem;
+  std::string keyPem;
+public:
+
+  /**
+   * Generate self-signed keypair.
+   * @param commonName - certificate CN.
+   * @return - KeyPair.
+   */
+  static KeyPair generate(const char* commonName);
+
+  /**
+   * Create server config using this keypair.
+   * @return - `std::shared_ptr` to &id:oatpp::libressl::Config;.
+   */
+  std::shared_ptr<oatpp::libressl::Config> createServerConfig() const;
+
+  /**
+   * Create client config which trusts any certificate (self-signed certificate can't be verified).
+   * @return - `std::shared_ptr` to &id:oatpp::libressl::Config;.
+   */
+  static std::shared_ptr<oatpp::libressl::Config> createClientConfig();
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_KeyPair_hpp */
@@ -0,0 +1,231 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "LoadGenerator.hpp"
+
+#include "oatpp-libressl/Connection.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+class LoadGenerator::Worker : public oatpp::async::Coroutine<Worker> {
+private:
+  LoadGenerator* m_generator;
+  std::shared_ptr<oatpp::libressl::Connection> m_connection;
+  std::vector<v_char8> m_buffer;
+  data::v_io_size m_offset;
+  v_int64 m_tick;
+  bool m_succeeded;
+public:
+
+  Worker(LoadGenerator* generator)
+    : m_generator(generator)
+    , m_buffer(generator->m_options.requestSize, 'r')
+    , m_offset(0)
+    , m_tick(0)
+    , m_succeeded(false)
+  {}
+
+  ~Worker() {
+    /* also reached when getConnectionAsync() fails with error */
+    if(!m_succeeded) {
+      m_generator->m_errors ++;
+    }
+    m_connection.reset();
+    m_generator->onWorkerDone();
+  }
+
+  Action act() override {
+    m_tick = oatpp::base::Environment::getMicroTickCount();
+    return m_generator->m_provider->getConnectionAsync().callbackTo(&Worker::onConnected);
+  }
+
+  Action onConnected(const std::shared_ptr<oatpp::data::stream::IOStream>& connection) {
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    m_generator->m_connectMicros.record(tick - m_tick);
+    m_connection = std::static_pointer_cast<oatpp::libressl::Connection>(connection);
+    m_tick = tick;
+    return yieldTo(&Worker::handshake);
+  }
+
+  Action handshake() {
+    auto res = m_connection->handshake();
+    if(res == data::IOError::WAIT_RETRY) {
+      return waitRetry();
+    }
+    if(res != 0) {
+      return finish();
+    }
+    m_generator->m_handshakeMicros.record(oatpp::base::Environment::getMicroTickCount() - m_tick);
+    m_generator->m_connections ++;
+    if(m_connection->getTlsInfo()->sessionResumed) {
+      m_generator->m_resumed ++;
+    }
+    return yieldTo(&Worker::startRequest);
+  }
+
+  Action startRequest() {
+    m_offset = 0;
+    m_tick = oatpp::base::Environment::getMicroTickCount();
+    return yieldTo(&Worker::writeRequest);
+  }
+
+  Action writeRequest() {
+    auto res = m_connection->write(&m_buffer[m_offset], m_buffer.size() - m_offset);
+    if(res == data::IOError::WAIT_RETRY) {
+      return waitRetry();
+    } else if(res == data::IOError::RETRY) {
+      return repeat();
+    } else if(res <= 0) {
+      return finish();
+    }
+    m_offset += res;
+    if(m_offset < (data::v_io_size) m_buffer.size()) {
+      return repeat();
+    }
+    m_offset = 0;
+    return yieldTo(&Worker::readResponse);
+  }
+
+  Action readResponse() {
+    auto res = m_connection->read(&m_buffer[m_offset], m_buffer.size() - m_offset);
+    if(res == data::IOError::WAIT_RETRY) {
+      return waitRetry();
+    } else if(res == data::IOError::RETRY) {
+      return repeat();
+    } else if(res <= 0) {
+      return finish();
+    }
+    m_offset += res;
+    if(m_offset < (data::v_io_size) m_buffer.size()) {
+      return repeat();
+    }
+
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    m_generator->m_roundTripMicros.record(tick - m_tick);
+    m_generator->m_requests ++;
+    m_generator->m_bytes += 2 * m_buffer.size();
+
+    if(m_generator->m_options.keepAlive && tick < m_generator->m_deadline) {
+      return yieldTo(&Worker::startRequest);
+    }
+    m_succeeded = true;
+    return finish();
+  }
+
+};
+
+LoadGenerator::LoadGenerator(const Options& options, const std::shared_ptr<oatpp::libressl::client::ConnectionProvider>& provider)
+  : m_options(options)
+  , m_provider(provider)
+  , m_deadline(0)
+  , m_active(0)
+  , m_connections(0)
+  , m_resumed(0)
+  , m_requests(0)
+  , m_bytes(0)
+  , m_errors(0)
+{
+  if(m_options.connectionsPerSecond > 0) {
+    m_connectLimiter = oatpp::libressl::RateLimiter::createShared(m_options.connectionsPerSecond, 1);
+  }
+}
+
+void LoadGenerator::onWorkerDone() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_active --;
+  m_condition.notify_all();
+}
+
+void LoadGenerator::run(Report& report, const std::string& variant) {
+
+  auto executor = std::make_shared<oatpp::async::Executor>(m_options.threads, 1, 1);
+
+  v_int64 start = oatpp::base::Environment::getMicroTickCount();
+  m_deadline = start + m_options.durationMicros;
+
+  {
+
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while(true) {
+
+      v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+      if(tick >= m_deadline) {
+        break;
+      }
+
+      if(m_active >= m_options.connections) {
+        m_condition.wait_for(lock, std::chrono::microseconds(m_deadline - tick));
+        continue;
+      }
+
+      if(m_connectLimiter && m_connectLimiter->acquire(1) == 0) {
+        m_condition.wait_for(lock, std::chrono::microseconds(m_connectLimiter->getWaitMicros()));
+        continue;
+      }
+
+      m_active ++;
+      lock.unlock();
+      executor->execute<Worker>(this);
+      lock.lock();
+
+    }
+
+    /* let connections in progress finish */
+    m_condition.wait(lock, [this]{ return m_active == 0; });
+
+  }
+
+  v_int64 micros = oatpp::base::Environment::getMicroTickCount() - start;
+  if(micros <= 0) {
+    micros = 1;
+  }
+
+  executor->stop();
+  executor->join();
+
+  v_int64 connections = m_connections.load();
+
+  report.add("loadgen", variant, "connections_per_sec", connections * 1000000.0 / micros, "1/s");
+  report.add("loadgen", variant, "requests_per_sec", m_requests.load() * 1000000.0 / micros, "1/s");
+  report.add("loadgen", variant, "throughput", m_bytes.load() / (1024.0 * 1024.0) * 1000000.0 / micros, "MB/s");
+  report.add("loadgen", variant, "resumed_ratio", connections > 0 ? m_resumed.load() / (v_float64) connections : 0, "");
+  report.add("loadgen", variant, "errors", m_errors.load(), "");
+
+  const v_float64 percentiles[] = {50, 99, 99.9};
+  const char* const names[] = {"p50", "p99", "p999"};
+
+  for(v_int32 i = 0; i < 3; i ++) {
+    report.add("loadgen", variant, std::string("connect_") + names[i], m_connectMicros.getPercentile(percentiles[i]), "us");
+    report.add("loadgen", variant, std::string("handshake_") + names[i], m_handshakeMicros.getPercentile(percentiles[i]), "us");
+    report.add("loadgen", variant, std::string("round_trip_") + names[i], m_roundTripMicros.getPercentile(percentiles[i]), "us");
+  }
+
+}
+
+}}}
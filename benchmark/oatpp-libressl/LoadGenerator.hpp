@@ -0,0 +1,131 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_LoadGenerator_hpp
+#define oatpp_benchmark_libressl_LoadGenerator_hpp
+
+#include "Histogram.hpp"
+#include "Report.hpp"
+
+#include "oatpp-libressl/client/ConnectionProvider.hpp"
+#include "oatpp-libressl/RateLimiter.hpp"
+
+#include "oatpp/core/async/Executor.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Drives many concurrent TLS connections to an echo server using
+ * &id:oatpp::libressl::client::ConnectionProvider::getConnectionAsync; on &id:oatpp::async::Executor;.
+ * Each connection is a coroutine: connect, handshake, then request/response round-trips.
+ * Records connect, handshake and round-trip latency distributions.
+ */
+class LoadGenerator {
+public:
+
+  /**
+   * Load parameters.
+   */
+  struct Options {
+
+    /**
+     * Max number of connections open at the same time.
+     */
+    v_int32 connections = 100;
+
+    /**
+     * Max rate of new connections per second. `0` - unlimited.
+     */
+    v_int64 connectionsPerSecond = 0;
+
+    /**
+     * Duration of the run in microseconds. Connections in progress are allowed to finish.
+     */
+    v_int64 durationMicros = 10 * 1000 * 1000;
+
+    /**
+     * Size of request in bytes. Server is expected to echo request back.
+     */
+    v_int32 requestSize = 64;
+
+    /**
+     * `true` - each connection sends requests until the end of the run.
+     * `false` - new connection is opened for each request.
+     */
+    bool keepAlive = false;
+
+    /**
+     * Number of processor threads of the executor.
+     */
+    v_int32 threads = 1;
+
+  };
+
+private:
+  class Worker;
+private:
+  void onWorkerDone();
+private:
+  Options m_options;
+  std::shared_ptr<oatpp::libressl::client::ConnectionProvider> m_provider;
+  std::shared_ptr<oatpp::libressl::RateLimiter> m_connectLimiter;
+  v_int64 m_deadline;
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  v_int32 m_active;
+private:
+  Histogram m_connectMicros;
+  Histogram m_handshakeMicros;
+  Histogram m_roundTripMicros;
+  std::atomic<v_int64> m_connections;
+  std::atomic<v_int64> m_resumed;
+  std::atomic<v_int64> m_requests;
+  std::atomic<v_int64> m_bytes;
+  std::atomic<v_int64> m_errors;
+public:
+
+  /**
+   * Constructor.
+   * @param options - &l:LoadGenerator::Options;.
+   * @param provider - provider of client connections to the server under load.
+   */
+  LoadGenerator(const Options& options, const std::shared_ptr<oatpp::libressl::client::ConnectionProvider>& provider);
+
+  /**
+   * Run load and add results to report.
+   * @param report - &id:oatpp::benchmark::libressl::Report;.
+   * @param variant - variant name in the report.
+   */
+  void run(Report& report, const std::string& variant);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_LoadGenerator_hpp */
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "MemoryBenchmark.hpp"
+
+#include "Utils.hpp"
+
+#include <string>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+  typedef oatpp::libressl::Connection Connection;
+}
+
+MemoryBenchmark::MemoryBenchmark(const KeyPair& keyPair, const std::vector<v_int32>& counts)
+  : m_keyPair(keyPair)
+  , m_counts(counts)
+{}
+
+void MemoryBenchmark::run(Report& report) {
+
+  auto serverConfig = m_keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  Connection::TLSHandle serverHandle = tls_server();
+  if(tls_configure(serverHandle, serverConfig->getTLSConfig()) < 0) {
+    OATPP_LOGE("MemoryBenchmark", "Failed to configure tls_server. %s", tls_error(serverHandle));
+    tls_free(serverHandle);
+    return;
+  }
+
+  for(v_int32 count : m_counts) {
+
+    std::vector<std::shared_ptr<Connection>> servers;
+    std::vector<std::shared_ptr<Connection>> clients;
+    servers.reserve(count);
+    clients.reserve(count);
+
+    v_int64 memoryBefore = Utils::getResidentMemory();
+
+    for(v_int32 i = 0; i < count; i ++) {
+      std::shared_ptr<Connection> server;
+      std::shared_ptr<Connection> client;
+      if(!Utils::createMemoryPair(serverHandle, clientConfig, server, client)) {
+        OATPP_LOGE("MemoryBenchmark", "Failed to create connection pair #%d", i);
+        break;
+      }
+      servers.push_back(server);
+      clients.push_back(client);
+    }
+
+    v_int64 memoryAfter = Utils::getResidentMemory();
+    v_int64 pairs = (v_int64) servers.size();
+
+    report.add("memory", "idle-connections=" + std::to_string(pairs), "bytes_per_pair",
+               pairs > 0 ? (memoryAfter - memoryBefore) / (v_float64) pairs : 0, "B");
+
+  }
+
+  tls_free(serverHandle);
+
+}
+
+}}}
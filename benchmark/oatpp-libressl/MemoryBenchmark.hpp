@@ -0,0 +1,55 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_MemoryBenchmark_hpp
+#define oatpp_benchmark_libressl_MemoryBenchmark_hpp
+
+#include "KeyPair.hpp"
+#include "Report.hpp"
+
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Measure memory per idle handshaked TLS connection.
+ * Server and client connections are created in-process over &l:MemoryPipe;, so no file descriptors are used
+ * and pipe buffers are drained before measurement.
+ */
+class MemoryBenchmark {
+private:
+  const KeyPair& m_keyPair;
+  std::vector<v_int32> m_counts;
+public:
+
+  MemoryBenchmark(const KeyPair& keyPair, const std::vector<v_int32>& counts);
+
+  void run(Report& report);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_MemoryBenchmark_hpp */
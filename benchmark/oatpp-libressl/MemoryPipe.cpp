@@ -0,0 +1,93 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "MemoryPipe.hpp"
+
+#include <cstring>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+MemoryPipe::Endpoint::Endpoint(const std::shared_ptr<Channel>& in, const std::shared_ptr<Channel>& out)
+  : m_in(in)
+  , m_out(out)
+  , m_writeBlocked(false)
+{}
+
+MemoryPipe::Endpoint::~Endpoint() {
+  m_out->closed = true;
+}
+
+data::v_io_size MemoryPipe::Endpoint::write(const void *buff, data::v_io_size count) {
+  if(m_out->closed) {
+    return data::IOError::BROKEN_PIPE;
+  }
+  if(m_writeBlocked) {
+    return data::IOError::WAIT_RETRY;
+  }
+  m_out->data.append((const char*) buff, count);
+  return count;
+}
+
+data::v_io_size MemoryPipe::Endpoint::read(void *buff, data::v_io_size count) {
+  data::v_io_size available = m_in->data.size() - m_in->position;
+  if(available == 0) {
+    if(m_in->closed) {
+      return 0;
+    }
+    return data::IOError::WAIT_RETRY;
+  }
+  if(count > available) {
+    count = available;
+  }
+  std::memcpy(buff, m_in->data.data() + m_in->position, count);
+  m_in->position += count;
+  if(m_in->position == m_in->data.size()) {
+    m_in->data.clear();
+    m_in->position = 0;
+  }
+  return count;
+}
+
+void MemoryPipe::Endpoint::shrink() {
+  if(m_in->data.empty()) {
+    std::string().swap(m_in->data);
+  }
+  if(m_out->data.empty()) {
+    std::string().swap(m_out->data);
+  }
+}
+
+void MemoryPipe::Endpoint::setWriteBlocked(bool blocked) {
+  m_writeBlocked = blocked;
+}
+
+void MemoryPipe::createPair(std::shared_ptr<Endpoint>& first, std::shared_ptr<Endpoint>& second) {
+  auto a = std::make_shared<Channel>();
+  auto b = std::make_shared<Channel>();
+  first = std::make_shared<Endpoint>(a, b);
+  second = std::make_shared<Endpoint>(b, a);
+}
+
+}}}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_MemoryPipe_hpp
+#define oatpp_benchmark_libressl_MemoryPipe_hpp
+
+#include "oatpp/core/data/stream/Stream.hpp"
+
+#include <memory>
+#include <string>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Single-threaded in-memory duplex pipe. No sockets, no locking.
+ * Read from empty pipe returns &id:oatpp::data::IOError::WAIT_RETRY;.
+ */
+class MemoryPipe {
+private:
+
+  struct Channel {
+    std::string data;
+    size_t position;
+    bool closed;
+    Channel() : position(0), closed(false) {}
+  };
+
+public:
+
+  /**
+   * One end of the pipe.
+   */
+  class Endpoint : public oatpp::data::stream::IOStream {
+  private:
+    std::shared_ptr<Channel> m_in;
+    std::shared_ptr<Channel> m_out;
+    bool m_writeBlocked;
+  public:
+
+    Endpoint(const std::shared_ptr<Channel>& in, const std::shared_ptr<Channel>& out);
+    ~Endpoint();
+
+    data::v_io_size write(const void *buff, data::v_io_size count) override;
+    data::v_io_size read(void *buff, data::v_io_size count) override;
+
+    /**
+     * Release memory of drained buffers.
+     */
+    void shrink();
+
+    /**
+     * Simulate full transport buffer - while blocked, write returns &id:oatpp::data::IOError::WAIT_RETRY;.
+     * @param blocked - `true` to block writes.
+     */
+    void setWriteBlocked(bool blocked);
+
+  };
+
+public:
+
+  /**
+   * Create connected pair of endpoints.
+   * @param first - first endpoint.
+   * @param second - second endpoint.
+   */
+  static void createPair(std::shared_ptr<Endpoint>& first, std::shared_ptr<Endpoint>& second);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_MemoryPipe_hpp */
@@ -0,0 +1,214 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "PipeBenchmark.hpp"
+
+#include "Utils.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+  typedef oatpp::libressl::Connection Connection;
+}
+
+PipeBenchmark::PipeBenchmark(const KeyPair& keyPair, v_int32 handshakes, v_int32 roundTrips, v_int64 bulkBytes,
+                             const std::vector<v_int32>& recordSizes)
+  : m_keyPair(keyPair)
+  , m_handshakes(handshakes)
+  , m_roundTrips(roundTrips)
+  , m_bulkBytes(bulkBytes)
+  , m_recordSizes(recordSizes)
+{}
+
+void PipeBenchmark::runHandshakes(Report& report, const char* variant,
+                                  const std::shared_ptr<oatpp::libressl::Config>& serverConfig,
+                                  const std::shared_ptr<oatpp::libressl::Config>& clientConfig)
+{
+
+  Connection::TLSHandle serverHandle = tls_server();
+  if(tls_configure(serverHandle, serverConfig->getTLSConfig()) < 0) {
+    OATPP_LOGE("PipeBenchmark", "[%s] Failed to configure tls_server. %s", variant, tls_error(serverHandle));
+    tls_free(serverHandle);
+    return;
+  }
+
+  v_int32 handshakes = 0;
+  v_int32 resumed = 0;
+
+  v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+  for(; handshakes < m_handshakes; handshakes ++) {
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    if(!Utils::createMemoryPair(serverHandle, clientConfig, server, client)) {
+      OATPP_LOGE("PipeBenchmark", "[%s] Handshake failed", variant);
+      break;
+    }
+    if(tls_conn_session_resumed(client->getTlsHandle()) == 1) {
+      resumed ++;
+    }
+  }
+  v_int64 micros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+  tls_free(serverHandle);
+
+  report.add("pipe", variant, "handshakes_per_sec", handshakes * 1000000.0 / (micros > 0 ? micros : 1), "1/s");
+  report.add("pipe", variant, "resumed_ratio", handshakes > 0 ? resumed / (v_float64) handshakes : 0, "");
+
+}
+
+void PipeBenchmark::runTransfers(Report& report) {
+
+  auto serverConfig = m_keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  Connection::TLSHandle serverHandle = tls_server();
+  if(tls_configure(serverHandle, serverConfig->getTLSConfig()) < 0) {
+    OATPP_LOGE("PipeBenchmark", "Failed to configure tls_server. %s", tls_error(serverHandle));
+    tls_free(serverHandle);
+    return;
+  }
+
+  std::shared_ptr<Connection> server;
+  std::shared_ptr<Connection> client;
+  if(!Utils::createMemoryPair(serverHandle, clientConfig, server, client)) {
+    OATPP_LOGE("PipeBenchmark", "Handshake failed");
+    tls_free(serverHandle);
+    return;
+  }
+
+  /* one write - one TLS record, up to the max record size of 16KB */
+
+  for(v_int32 recordSize : m_recordSizes) {
+
+    std::vector<v_char8> buffer(recordSize, 'b');
+    v_int64 transferred = 0;
+
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    while(transferred < m_bulkBytes) {
+      if(!Utils::writeExactly(client.get(), buffer.data(), buffer.size()) ||
+         !Utils::readExactly(server.get(), buffer.data(), buffer.size()))
+      {
+        OATPP_LOGE("PipeBenchmark", "[record=%d] Bulk transfer failed", recordSize);
+        break;
+      }
+      transferred += buffer.size();
+    }
+    v_int64 micros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+    report.add("pipe", "record=" + std::to_string(recordSize), "bulk_throughput",
+               transferred / (1024.0 * 1024.0) * 1000000.0 / (micros > 0 ? micros : 1), "MB/s");
+
+  }
+
+  v_char8 message[64];
+  std::memset(message, 'm', sizeof(message));
+
+  v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+  for(v_int32 i = 0; i < m_roundTrips; i ++) {
+    if(!Utils::writeExactly(client.get(), message, sizeof(message)) ||
+       !Utils::readExactly(server.get(), message, sizeof(message)) ||
+       !Utils::writeExactly(server.get(), message, sizeof(message)) ||
+       !Utils::readExactly(client.get(), message, sizeof(message)))
+    {
+      OATPP_LOGE("PipeBenchmark", "Round-trip failed");
+      break;
+    }
+  }
+  v_int64 micros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+  report.add("pipe", "message=64", "round_trip", micros / (v_float64) (m_roundTrips > 0 ? m_roundTrips : 1), "us");
+
+  server.reset();
+  client.reset();
+  tls_free(serverHandle);
+
+}
+
+void PipeBenchmark::runConfigure(Report& report) {
+
+  auto serverConfig = m_keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  v_int64 clientMicros = 0;
+  v_int64 serverMicros = 0;
+
+  for(v_int32 i = 0; i < m_handshakes; i ++) {
+
+    Connection::TLSHandle client = tls_client();
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    tls_configure(client, clientConfig->getTLSConfig());
+    clientMicros += oatpp::base::Environment::getMicroTickCount() - tick;
+    tls_free(client);
+
+    Connection::TLSHandle server = tls_server();
+    tick = oatpp::base::Environment::getMicroTickCount();
+    tls_configure(server, serverConfig->getTLSConfig());
+    serverMicros += oatpp::base::Environment::getMicroTickCount() - tick;
+    tls_free(server);
+
+  }
+
+  v_int32 count = m_handshakes > 0 ? m_handshakes : 1;
+  report.add("pipe", "client", "tls_configure", clientMicros / (v_float64) count, "us");
+  report.add("pipe", "server", "tls_configure", serverMicros / (v_float64) count, "us");
+
+}
+
+void PipeBenchmark::run(Report& report) {
+
+  /* TLS 1.2 - resumption in libtls is done with TLS 1.2 session tickets */
+
+  auto serverConfig = m_keyPair.createServerConfig();
+  serverConfig->setPreset(oatpp::libressl::Config::CIPHERS_AUTO, oatpp::libressl::Config::PROTOCOLS_TLS12_ONLY);
+  tls_config_set_session_lifetime(serverConfig->getTLSConfig(), 60 * 60);
+
+  runHandshakes(report, "full", serverConfig, KeyPair::createClientConfig());
+
+  /* client keeps its session in a file and offers it on each connect */
+
+  char sessionPath[] = "/tmp/oatpp-libressl-benchmark-session-XXXXXX";
+  int sessionFd = mkstemp(sessionPath);
+  if(sessionFd >= 0) {
+    ::unlink(sessionPath);
+    auto clientConfig = KeyPair::createClientConfig();
+    if(tls_config_set_session_fd(clientConfig->getTLSConfig(), sessionFd) == 0) {
+      runHandshakes(report, "resumed", serverConfig, clientConfig);
+    } else {
+      OATPP_LOGE("PipeBenchmark", "Failed to set session fd");
+    }
+    ::close(sessionFd);
+  }
+
+  runTransfers(report);
+  runConfigure(report);
+
+}
+
+}}}
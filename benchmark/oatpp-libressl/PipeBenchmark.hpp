@@ -0,0 +1,65 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_PipeBenchmark_hpp
+#define oatpp_benchmark_libressl_PipeBenchmark_hpp
+
+#include "KeyPair.hpp"
+#include "Report.hpp"
+
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * TLS over &l:MemoryPipe; - no kernel involved, so results reflect TLS CPU cost only.
+ * Measures full and resumed handshakes per second, bulk throughput per record size,
+ * small message round-trip and the cost of `tls_configure()` which is paid on each client connect.
+ */
+class PipeBenchmark {
+private:
+  const KeyPair& m_keyPair;
+  v_int32 m_handshakes;
+  v_int32 m_roundTrips;
+  v_int64 m_bulkBytes;
+  std::vector<v_int32> m_recordSizes;
+private:
+  void runHandshakes(Report& report, const char* variant,
+                     const std::shared_ptr<oatpp::libressl::Config>& serverConfig,
+                     const std::shared_ptr<oatpp::libressl::Config>& clientConfig);
+  void runTransfers(Report& report);
+  void runConfigure(Report& report);
+public:
+
+  PipeBenchmark(const KeyPair& keyPair, v_int32 handshakes, v_int32 roundTrips, v_int64 bulkBytes,
+                const std::vector<v_int32>& recordSizes);
+
+  void run(Report& report);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_PipeBenchmark_hpp */
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "PresetBenchmark.hpp"
+
+#include "Utils.hpp"
+
+#include <string>
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Config Config;
+  typedef oatpp::libressl::Connection Connection;
+
+  const char* getPresetName(Config::CipherPreset ciphers) {
+    switch(ciphers) {
+      case Config::CIPHERS_AES_GCM_FIRST: return "aes-gcm-first";
+      case Config::CIPHERS_CHACHA20_FIRST: return "chacha20-first";
+      default: return "auto";
+    }
+  }
+
+  const char* getProfileName(Config::ProtocolProfile protocols) {
+    switch(protocols) {
+      case Config::PROTOCOLS_TLS12_ONLY: return "tls1.2-only";
+      case Config::PROTOCOLS_TLS13_ONLY: return "tls1.3-only";
+      default: return "tls1.3-preferred";
+    }
+  }
+
+}
+
+PresetBenchmark::PresetBenchmark(const KeyPair& keyPair, v_int32 handshakes, v_int64 bulkBytes)
+  : m_keyPair(keyPair)
+  , m_handshakes(handshakes)
+  , m_bulkBytes(bulkBytes)
+{}
+
+void PresetBenchmark::run(Report& report) {
+
+  const Config::CipherPreset presets[] = {Config::CIPHERS_AES_GCM_FIRST, Config::CIPHERS_CHACHA20_FIRST};
+  const Config::ProtocolProfile profiles[] = {Config::PROTOCOLS_TLS12_ONLY, Config::PROTOCOLS_TLS13_PREFERRED};
+
+  auto clientConfig = KeyPair::createClientConfig();
+  std::vector<v_char8> buffer(16 * 1024);
+
+  for(auto preset : presets) {
+    for(auto profile : profiles) {
+
+      auto serverConfig = m_keyPair.createServerConfig();
+      serverConfig->setPreset(preset, profile);
+
+      Connection::TLSHandle serverHandle = tls_server();
+      if(tls_configure(serverHandle, serverConfig->getTLSConfig()) < 0) {
+        OATPP_LOGE("PresetBenchmark", "Failed to configure tls_server. %s", tls_error(serverHandle));
+        tls_free(serverHandle);
+        continue;
+      }
+
+      std::shared_ptr<Connection> server;
+      std::shared_ptr<Connection> client;
+
+      v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+      v_int32 handshakes = 0;
+      for(; handshakes < m_handshakes; handshakes ++) {
+        if(!Utils::createMemoryPair(serverHandle, clientConfig, server, client)) {
+          OATPP_LOGE("PresetBenchmark", "[%s, %s] Handshake failed", getPresetName(preset), getProfileName(profile));
+          break;
+        }
+      }
+      v_int64 handshakeMicros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+      if(handshakes == 0) {
+        tls_free(serverHandle);
+        continue;
+      }
+
+      v_int64 transferred = 0;
+      tick = oatpp::base::Environment::getMicroTickCount();
+      while(transferred < m_bulkBytes) {
+        if(!Utils::writeExactly(client.get(), buffer.data(), buffer.size()) ||
+           !Utils::readExactly(server.get(), buffer.data(), buffer.size()))
+        {
+          OATPP_LOGE("PresetBenchmark", "[%s, %s] Bulk transfer failed", getPresetName(preset), getProfileName(profile));
+          break;
+        }
+        transferred += buffer.size();
+      }
+      v_int64 bulkMicros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+      auto info = client->getTlsInfo();
+
+      std::string variant = std::string(getPresetName(preset)) + "/" + getProfileName(profile) + "/" +
+                            (info && info->cipher ? info->cipher->c_str() : "?");
+
+      report.add("preset", variant, "handshakes_per_sec",
+                 handshakes * 1000000.0 / (handshakeMicros > 0 ? handshakeMicros : 1), "1/s");
+      report.add("preset", variant, "bulk_throughput",
+                 transferred / (1024.0 * 1024.0) * 1000000.0 / (bulkMicros > 0 ? bulkMicros : 1), "MB/s");
+
+      server.reset();
+      client.reset();
+      tls_free(serverHandle);
+
+    }
+  }
+
+}
+
+}}}
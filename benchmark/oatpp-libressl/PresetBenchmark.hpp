@@ -0,0 +1,54 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_PresetBenchmark_hpp
+#define oatpp_benchmark_libressl_PresetBenchmark_hpp
+
+#include "KeyPair.hpp"
+#include "Report.hpp"
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Compare &id:oatpp::libressl::Config::CipherPreset; and &id:oatpp::libressl::Config::ProtocolProfile;
+ * combinations on the current machine. Measures handshakes per second and bulk throughput.
+ * Connections are created in-process over &l:MemoryPipe;, so results reflect TLS CPU cost only.
+ */
+class PresetBenchmark {
+private:
+  const KeyPair& m_keyPair;
+  v_int32 m_handshakes;
+  v_int64 m_bulkBytes;
+public:
+
+  PresetBenchmark(const KeyPair& keyPair, v_int32 handshakes, v_int64 bulkBytes);
+
+  void run(Report& report);
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_PresetBenchmark_hpp */
@@ -0,0 +1,90 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Report.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+void Report::writeString(std::ostream& stream, const std::string& value) {
+  stream << '"';
+  for(char c : value) {
+    switch(c) {
+      case '"': stream << "\\\""; break;
+      case '\\': stream << "\\\\"; break;
+      case '\n': stream << "\\n"; break;
+      default:
+        if((unsigned char) c < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int) c);
+          stream << buffer;
+        } else {
+          stream << c;
+        }
+    }
+  }
+  stream << '"';
+}
+
+void Report::setEnvironment(const std::string& name, const std::string& value) {
+  m_environment.push_back({name, value});
+}
+
+void Report::add(const std::string& suite, const std::string& variant, const std::string& metric, v_float64 value, const std::string& unit) {
+  m_results.push_back({suite, variant, metric, value, unit});
+  OATPP_LOGD("Report", "[%s, %s] %s=%.2f%s", suite.c_str(), variant.c_str(), metric.c_str(), value, unit.c_str());
+}
+
+void Report::writeJson(std::ostream& stream) const {
+
+  stream << "{\n  \"environment\": {";
+  for(size_t i = 0; i < m_environment.size(); i ++) {
+    stream << (i == 0 ? "\n    " : ",\n    ");
+    writeString(stream, m_environment[i].first);
+    stream << ": ";
+    writeString(stream, m_environment[i].second);
+  }
+  stream << "\n  },\n  \"results\": [";
+
+  for(size_t i = 0; i < m_results.size(); i ++) {
+    const Result& result = m_results[i];
+    char value[64];
+    std::snprintf(value, sizeof(value), "%.3f", std::isfinite(result.value) ? result.value : 0.0);
+    stream << (i == 0 ? "\n    {" : ",\n    {");
+    stream << "\"suite\": "; writeString(stream, result.suite);
+    stream << ", \"variant\": "; writeString(stream, result.variant);
+    stream << ", \"metric\": "; writeString(stream, result.metric);
+    stream << ", \"value\": " << value;
+    stream << ", \"unit\": "; writeString(stream, result.unit);
+    stream << "}";
+  }
+
+  stream << "\n  ]\n}\n";
+
+}
+
+}}}
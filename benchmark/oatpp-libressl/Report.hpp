@@ -0,0 +1,86 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_Report_hpp
+#define oatpp_benchmark_libressl_Report_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * Benchmark results collected for machine-readable JSON output.
+ * Each result is identified by suite, variant and metric, so that runs of different releases can be diffed.
+ */
+class Report {
+private:
+
+  struct Result {
+    std::string suite;
+    std::string variant;
+    std::string metric;
+    v_float64 value;
+    std::string unit;
+  };
+
+private:
+  std::vector<std::pair<std::string, std::string>> m_environment;
+  std::vector<Result> m_results;
+private:
+  static void writeString(std::ostream& stream, const std::string& value);
+public:
+
+  /**
+   * Add environment property. Ex.: library version, CPU features.
+   * @param name - property name.
+   * @param value - property value.
+   */
+  void setEnvironment(const std::string& name, const std::string& value);
+
+  /**
+   * Add result. Also logged for humans.
+   * @param suite - benchmark suite. Ex.: "transport".
+   * @param variant - variant within suite. Ex.: "tcp-loopback".
+   * @param metric - metric name. Ex.: "handshakes_per_sec".
+   * @param value - measured value.
+   * @param unit - unit of value. Ex.: "1/s", "us", "MB/s".
+   */
+  void add(const std::string& suite, const std::string& variant, const std::string& metric, v_float64 value, const std::string& unit);
+
+  /**
+   * Write report as JSON.
+   * @param stream - output stream.
+   */
+  void writeJson(std::ostream& stream) const;
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_Report_hpp */
@@ -0,0 +1,162 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "TransportBenchmark.hpp"
+
+#include "EchoServer.hpp"
+#include "Utils.hpp"
+
+#include "oatpp-libressl/Connection.hpp"
+#include "oatpp-libressl/client/ConnectionProvider.hpp"
+#include "oatpp-libressl/server/ConnectionProvider.hpp"
+#include "oatpp-libressl/uring/ServerConnectionProvider.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+
+  const v_word16 TCP_PORT = 18443;
+  const v_word16 URING_PORT = 18445;
+
+#if defined(__linux__)
+  const char* const UNIX_PATH = "@oatpp-libressl-benchmark";
+#else
+  const char* const UNIX_PATH = "/tmp/oatpp-libressl-benchmark.sock";
+#endif
+
+  void runTransport(const char* transport,
+                    const std::shared_ptr<oatpp::network::ServerConnectionProvider>& serverProvider,
+                    const std::shared_ptr<oatpp::network::ClientConnectionProvider>& clientProvider,
+                    v_int32 handshakes, v_int32 roundTrips, v_int64 bulkBytes,
+                    Report& report)
+  {
+
+    EchoServer server(serverProvider);
+    server.start();
+
+    /* full handshakes */
+
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    for(v_int32 i = 0; i < handshakes; i ++) {
+      auto connection = std::static_pointer_cast<oatpp::libressl::Connection>(clientProvider->getConnection());
+      if(!connection || connection->handshake() != 0) {
+        OATPP_LOGE("TransportBenchmark", "[%s] handshake failed", transport);
+        break;
+      }
+    }
+    v_int64 handshakeMicros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+    auto connection = clientProvider->getConnection();
+    if(!connection) {
+      OATPP_LOGE("TransportBenchmark", "[%s] can't connect - variant skipped", transport);
+      server.stop(clientProvider);
+      return;
+    }
+
+    /* small messages round-trip */
+
+    v_char8 message[64];
+    std::memset(message, 'm', sizeof(message));
+
+    tick = oatpp::base::Environment::getMicroTickCount();
+    for(v_int32 i = 0; i < roundTrips; i ++) {
+      if(!Utils::roundTrip(connection.get(), message, sizeof(message))) {
+        OATPP_LOGE("TransportBenchmark", "[%s] round-trip failed", transport);
+        break;
+      }
+    }
+    v_int64 roundTripMicros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+    /* bulk */
+
+    std::vector<v_char8> chunk(16 * 1024, 'b');
+    v_int64 transferred = 0;
+
+    tick = oatpp::base::Environment::getMicroTickCount();
+    while(transferred < bulkBytes) {
+      if(!Utils::roundTrip(connection.get(), chunk.data(), chunk.size())) {
+        OATPP_LOGE("TransportBenchmark", "[%s] bulk transfer failed", transport);
+        break;
+      }
+      transferred += chunk.size();
+    }
+    v_int64 bulkMicros = oatpp::base::Environment::getMicroTickCount() - tick;
+
+    connection.reset();
+    server.stop(clientProvider);
+
+    report.add("transport", transport, "handshakes_per_sec",
+               handshakes * 1000000.0 / (handshakeMicros > 0 ? handshakeMicros : 1), "1/s");
+    report.add("transport", transport, "round_trip_64b",
+               roundTripMicros / (v_float64) (roundTrips > 0 ? roundTrips : 1), "us");
+    report.add("transport", transport, "bulk_echo_throughput",
+               (transferred * 2.0 / (1024 * 1024)) * 1000000.0 / (bulkMicros > 0 ? bulkMicros : 1), "MB/s");
+
+  }
+
+}
+
+TransportBenchmark::TransportBenchmark(const KeyPair& keyPair, v_int32 handshakes, v_int32 roundTrips, v_int64 bulkBytes)
+  : m_keyPair(keyPair)
+  , m_handshakes(handshakes)
+  , m_roundTrips(roundTrips)
+  , m_bulkBytes(bulkBytes)
+{}
+
+void TransportBenchmark::run(Report& report) {
+
+  auto serverConfig = m_keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  {
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, TCP_PORT);
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, "127.0.0.1", TCP_PORT);
+    runTransport("tcp-loopback", serverProvider, clientProvider, m_handshakes, m_roundTrips, m_bulkBytes, report);
+  }
+
+  {
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, oatpp::String(UNIX_PATH));
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, oatpp::String(UNIX_PATH), "localhost");
+    runTransport("unix", serverProvider, clientProvider, m_handshakes, m_roundTrips, m_bulkBytes, report);
+  }
+
+  {
+    /* server sockets over io_uring, falls back to recv()/send() if io_uring is not available */
+    auto ring = oatpp::libressl::uring::Ring::createShared();
+    auto streamProvider = oatpp::libressl::uring::ServerConnectionProvider::createShared(ring, URING_PORT);
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, streamProvider);
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, "127.0.0.1", URING_PORT);
+    const char* transport = ring->isAvailable() ? "tcp-loopback-io_uring" : "tcp-loopback-io_uring-fallback";
+    runTransport(transport, serverProvider, clientProvider, m_handshakes, m_roundTrips, m_bulkBytes, report);
+    report.add("transport", transport, "io_uring_enter_calls", ring->getEnterCalls(), "");
+    report.add("transport", transport, "io_uring_submitted", ring->getSubmittedCount(), "");
+  }
+
+}
+
+}}}
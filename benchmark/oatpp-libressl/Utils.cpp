@@ -0,0 +1,157 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Utils.hpp"
+
+#include "MemoryPipe.hpp"
+
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+namespace {
+  typedef oatpp::libressl::Connection Connection;
+  const v_int32 MAX_HANDSHAKE_STEPS = 100;
+}
+
+bool Utils::writeExactly(oatpp::data::stream::IOStream* stream, const void* data, data::v_io_size count) {
+  const v_char8* bytes = (const v_char8*) data;
+  data::v_io_size offset = 0;
+  while(offset < count) {
+    auto res = stream->write(&bytes[offset], count - offset);
+    if(res == data::IOError::WAIT_RETRY || res == data::IOError::RETRY) {
+      continue;
+    }
+    if(res <= 0) {
+      return false;
+    }
+    offset += res;
+  }
+  return true;
+}
+
+bool Utils::readExactly(oatpp::data::stream::IOStream* stream, void* data, data::v_io_size count) {
+  v_char8* bytes = (v_char8*) data;
+  data::v_io_size offset = 0;
+  while(offset < count) {
+    auto res = stream->read(&bytes[offset], count - offset);
+    if(res == data::IOError::WAIT_RETRY || res == data::IOError::RETRY) {
+      continue;
+    }
+    if(res <= 0) {
+      return false;
+    }
+    offset += res;
+  }
+  return true;
+}
+
+bool Utils::roundTrip(oatpp::data::stream::IOStream* stream, void* buffer, data::v_io_size count) {
+  return writeExactly(stream, buffer, count) && readExactly(stream, buffer, count);
+}
+
+bool Utils::createMemoryPair(Connection::TLSHandle serverHandle,
+                             const std::shared_ptr<oatpp::libressl::Config>& clientConfig,
+                             std::shared_ptr<Connection>& server,
+                             std::shared_ptr<Connection>& client)
+{
+
+  std::shared_ptr<MemoryPipe::Endpoint> serverStream;
+  std::shared_ptr<MemoryPipe::Endpoint> clientStream;
+  MemoryPipe::createPair(serverStream, clientStream);
+
+  Connection::TLSHandle serverConnectionHandle;
+  if(tls_accept_cbs(serverHandle, &serverConnectionHandle, Connection::readCallback, Connection::writeCallback, serverStream.get()) < 0) {
+    return false;
+  }
+  server = Connection::createShared(serverConnectionHandle, serverStream);
+
+  Connection::TLSHandle clientHandle = tls_client();
+  if(clientHandle == nullptr) {
+    server = nullptr;
+    return false;
+  }
+  if(tls_configure(clientHandle, clientConfig->getTLSConfig()) < 0 ||
+     tls_connect_cbs(clientHandle, Connection::readCallback, Connection::writeCallback, clientStream.get(), "localhost") < 0)
+  {
+    tls_free(clientHandle);
+    server = nullptr;
+    return false;
+  }
+  client = Connection::createShared(clientHandle, clientStream);
+
+  /* in-memory handshake takes a few round trips - more means the peers don't make progress */
+  bool done = false;
+  for(v_int32 i = 0; i < MAX_HANDSHAKE_STEPS; i ++) {
+    auto clientResult = client->handshake();
+    auto serverResult = server->handshake();
+    if(clientResult == 0 && serverResult == 0) {
+      done = true;
+      break;
+    }
+    if((clientResult != 0 && clientResult != data::IOError::WAIT_RETRY) ||
+       (serverResult != 0 && serverResult != data::IOError::WAIT_RETRY))
+    {
+      break;
+    }
+  }
+
+  if(!done) {
+    return false;
+  }
+
+  serverStream->shrink();
+  clientStream->shrink();
+
+  return true;
+
+}
+
+v_int64 Utils::getResidentMemory() {
+
+  FILE* file = std::fopen("/proc/self/statm", "r");
+  if(file != nullptr) {
+    long size = 0;
+    long resident = 0;
+    int count = std::fscanf(file, "%ld %ld", &size, &resident);
+    std::fclose(file);
+    if(count == 2) {
+      return (v_int64) resident * sysconf(_SC_PAGESIZE);
+    }
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return (v_int64) usage.ru_maxrss * 1024;
+#endif
+
+}
+
+}}}
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_benchmark_libressl_Utils_hpp
+#define oatpp_benchmark_libressl_Utils_hpp
+
+#include "oatpp-libressl/Config.hpp"
+#include "oatpp-libressl/Connection.hpp"
+
+#include "oatpp/core/data/stream/Stream.hpp"
+
+namespace oatpp { namespace benchmark { namespace libressl {
+
+/**
+ * I/O and measurement helpers for benchmarks.
+ */
+class Utils {
+public:
+
+  /**
+   * Write whole buffer.
+   * @return - `true` on success.
+   */
+  static bool writeExactly(oatpp::data::stream::IOStream* stream, const void* data, data::v_io_size count);
+
+  /**
+   * Read exactly `count` bytes.
+   * @return - `true` on success.
+   */
+  static bool readExactly(oatpp::data::stream::IOStream* stream, void* data, data::v_io_size count);
+
+  /**
+   * Write `count` bytes and read them back from echo server.
+   * @return - `true` on success.
+   */
+  static bool roundTrip(oatpp::data::stream::IOStream* stream, void* buffer, data::v_io_size count);
+
+  /**
+   * Create handshaked server and client connections over &l:MemoryPipe;.
+   * @param serverHandle - configured `tls_server()` context.
+   * @param clientConfig - client config.
+   * @param server - server connection.
+   * @param client - client connection.
+   * @return - `true` on success. If the handshake fails, connections are kept - see
+   * &id:oatpp::libressl::Connection::getLastError;.
+   */
+  static bool createMemoryPair(oatpp::libressl::Connection::TLSHandle serverHandle,
+                               const std::shared_ptr<oatpp::libressl::Config>& clientConfig,
+                               std::shared_ptr<oatpp::libressl::Connection>& server,
+                               std::shared_ptr<oatpp::libressl::Connection>& client);
+
+  /**
+   * Get resident memory of the process.
+   * @return - bytes. On platforms without `/proc/self/statm` - peak resident memory.
+   */
+  static v_int64 getResidentMemory();
+
+};
+
+}}}
+
+#endif /* oatpp_benchmark_libressl_Utils_hpp */
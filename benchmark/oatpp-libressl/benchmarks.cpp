@@ -0,0 +1,106 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "KeyPair.hpp"
+#include "MemoryBenchmark.hpp"
+#include "PipeBenchmark.hpp"
+#include "PresetBenchmark.hpp"
+#include "Report.hpp"
+#include "TransportBenchmark.hpp"
+
+#include "oatpp-libressl/Callbacks.hpp"
+#include "oatpp-libressl/Config.hpp"
+
+#include "oatpp/core/concurrency/SpinLock.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+class Logger : public oatpp::base::Logger {
+private:
+  oatpp::concurrency::SpinLock::Atom m_atom;
+public:
+
+  Logger()
+  : m_atom(false)
+  {}
+
+  void log(v_int32 priority, const std::string& tag, const std::string& message) override {
+    oatpp::concurrency::SpinLock lock(m_atom);
+    std::cerr << tag << ":" << message << "\n";
+  }
+
+};
+
+void runBenchmarks(oatpp::benchmark::libressl::Report& report) {
+
+  /* set lockingCallback for libressl */
+  oatpp::libressl::Callbacks::setDefaultCallbacks();
+
+  auto keyPair = oatpp::benchmark::libressl::KeyPair::generate("localhost");
+
+  report.setEnvironment("tls_api", std::to_string(TLS_API));
+  report.setEnvironment("hardware_aes", oatpp::libressl::Config::hasHardwareAes() ? "true" : "false");
+
+  oatpp::benchmark::libressl::PipeBenchmark(keyPair, 1000, 10000, 256 * 1024 * 1024, {512, 1024, 4096, 16384}).run(report);
+  oatpp::benchmark::libressl::TransportBenchmark(keyPair, 1000, 10000, 256 * 1024 * 1024).run(report);
+  oatpp::benchmark::libressl::MemoryBenchmark(keyPair, {10000, 100000}).run(report);
+  oatpp::benchmark::libressl::PresetBenchmark(keyPair, 1000, 256 * 1024 * 1024).run(report);
+
+}
+
+}
+
+/**
+ * Usage: module-benchmarks [<output.json>]
+ * Human-readable log goes to stderr. JSON report goes to the file, or to stdout if no file given.
+ */
+int main(int argc, char* argv[]) {
+
+  std::signal(SIGPIPE, SIG_IGN);
+
+  oatpp::base::Environment::init();
+  oatpp::base::Environment::setLogger(new Logger());
+
+  oatpp::benchmark::libressl::Report report;
+  runBenchmarks(report);
+
+  if(argc > 1) {
+    std::ofstream file(argv[1]);
+    report.writeJson(file);
+  } else {
+    report.writeJson(std::cout);
+  }
+
+  oatpp::base::Environment::setLogger(nullptr);
+  oatpp::base::Environment::destroy();
+
+  return 0;
+}
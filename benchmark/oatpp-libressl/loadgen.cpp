@@ -0,0 +1,241 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "EchoServer.hpp"
+#include "KeyPair.hpp"
+#include "LoadGenerator.hpp"
+#include "Report.hpp"
+
+#include "oatpp-libressl/Callbacks.hpp"
+#include "oatpp-libressl/server/ConnectionProvider.hpp"
+
+#include "oatpp/core/concurrency/SpinLock.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const v_word16 LOCAL_PORT = 18444;
+
+class Logger : public oatpp::base::Logger {
+private:
+  oatpp::concurrency::SpinLock::Atom m_atom;
+public:
+
+  Logger()
+  : m_atom(false)
+  {}
+
+  void log(v_int32 priority, const std::string& tag, const std::string& message) override {
+    oatpp::concurrency::SpinLock lock(m_atom);
+    std::cerr << tag << ":" << message << "\n";
+  }
+
+};
+
+struct Arguments {
+  oatpp::benchmark::libressl::LoadGenerator::Options options;
+  std::string host;
+  v_word16 port = LOCAL_PORT;
+  bool resume = false;
+  std::string output;
+};
+
+void printUsage() {
+  std::cerr <<
+    "Usage: tls-loadgen [options]\n"
+    "  --host=<host>          server to load. Default - start local echo server on 127.0.0.1\n"
+    "  --port=<port>          server port (default 18444)\n"
+    "  --connections=<n>      max concurrent connections (default 100)\n"
+    "  --rate=<n>             max new connections per second, 0 - unlimited (default 0)\n"
+    "  --duration=<seconds>   duration of the run (default 10)\n"
+    "  --request-size=<bytes> request size, server must echo it back (default 64)\n"
+    "  --keep-alive           send requests over the same connection until the end of the run\n"
+    "                         (default - new connection per request)\n"
+    "  --resume               resume TLS sessions (TLS 1.2 session tickets)\n"
+    "  --threads=<n>          executor processor threads (default 1)\n"
+    "  --output=<file>        write JSON report to file (default - stdout)\n";
+}
+
+bool parseArguments(int argc, char* argv[], Arguments& arguments) {
+
+  for(int i = 1; i < argc; i ++) {
+
+    std::string arg = argv[i];
+    std::string name = arg;
+    std::string value;
+
+    auto pos = arg.find('=');
+    if(pos != std::string::npos) {
+      name = arg.substr(0, pos);
+      value = arg.substr(pos + 1);
+    }
+
+    if(name == "--host") {
+      arguments.host = value;
+    } else if(name == "--port") {
+      arguments.port = (v_word16) std::atoi(value.c_str());
+    } else if(name == "--connections") {
+      arguments.options.connections = std::atoi(value.c_str());
+    } else if(name == "--rate") {
+      arguments.options.connectionsPerSecond = std::atoll(value.c_str());
+    } else if(name == "--duration") {
+      arguments.options.durationMicros = (v_int64) (std::atof(value.c_str()) * 1000 * 1000);
+    } else if(name == "--request-size") {
+      arguments.options.requestSize = std::atoi(value.c_str());
+    } else if(name == "--keep-alive") {
+      arguments.options.keepAlive = true;
+    } else if(name == "--resume") {
+      arguments.resume = true;
+    } else if(name == "--threads") {
+      arguments.options.threads = std::atoi(value.c_str());
+    } else if(name == "--output") {
+      arguments.output = value;
+    } else {
+      std::cerr << "Unknown option '" << arg << "'\n";
+      return false;
+    }
+
+  }
+
+  if(arguments.options.connections < 1 || arguments.options.requestSize < 1 || arguments.options.threads < 1 ||
+     arguments.options.durationMicros <= 0 || arguments.port == 0)
+  {
+    std::cerr << "Invalid option value\n";
+    return false;
+  }
+
+  return true;
+
+}
+
+int runLoad(const Arguments& arguments) {
+
+  oatpp::benchmark::libressl::Report report;
+
+  std::shared_ptr<oatpp::libressl::Config> serverConfig;
+  std::unique_ptr<oatpp::benchmark::libressl::EchoServer> server;
+
+  std::string host = arguments.host;
+  if(host.empty()) {
+    host = "127.0.0.1";
+    serverConfig = oatpp::benchmark::libressl::KeyPair::generate("localhost").createServerConfig();
+    if(arguments.resume) {
+      tls_config_set_session_lifetime(serverConfig->getTLSConfig(), 60 * 60);
+    }
+    server.reset(new oatpp::benchmark::libressl::EchoServer(
+      oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, arguments.port)
+    ));
+    server->start();
+  }
+
+  /* load generator measures TLS cost, not PKI - certificate of the server is not verified */
+  auto clientConfig = oatpp::benchmark::libressl::KeyPair::createClientConfig();
+
+  /* libtls keeps one session per config in a file. TLS 1.3 sessions are not resumable by libtls client */
+  int sessionFd = -1;
+  if(arguments.resume) {
+    clientConfig->setPreset(oatpp::libressl::Config::CIPHERS_AUTO, oatpp::libressl::Config::PROTOCOLS_TLS12_ONLY);
+    char sessionPath[] = "/tmp/oatpp-libressl-loadgen-session-XXXXXX";
+    sessionFd = mkstemp(sessionPath);
+    if(sessionFd < 0 || tls_config_set_session_fd(clientConfig->getTLSConfig(), sessionFd) != 0) {
+      std::cerr << "Can't set up session file\n";
+      if(server) {
+        server->stop(oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, host.c_str(), arguments.port));
+      }
+      return 1;
+    }
+    ::unlink(sessionPath);
+  }
+
+  auto provider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, host.c_str(), arguments.port);
+
+  std::string variant = std::string(arguments.options.keepAlive ? "keep-alive" : "connection-per-request")
+                      + (arguments.resume ? "/resumed" : "/full")
+                      + "/connections=" + std::to_string(arguments.options.connections)
+                      + "/request=" + std::to_string(arguments.options.requestSize);
+
+  oatpp::benchmark::libressl::LoadGenerator(arguments.options, provider).run(report, variant);
+
+  if(server) {
+    server->stop(provider);
+  }
+
+  if(sessionFd >= 0) {
+    ::close(sessionFd);
+  }
+
+  if(!arguments.output.empty()) {
+    std::ofstream file(arguments.output);
+    report.writeJson(file);
+  } else {
+    report.writeJson(std::cout);
+  }
+
+  return 0;
+
+}
+
+}
+
+/**
+ * TLS load generator. See `tls-loadgen --help`.
+ * Human-readable log goes to stderr. JSON report goes to the file, or to stdout if no file given.
+ */
+int main(int argc, char* argv[]) {
+
+  Arguments arguments;
+  if(argc > 1 && (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0)) {
+    printUsage();
+    return 0;
+  }
+  if(!parseArguments(argc, argv, arguments)) {
+    printUsage();
+    return 1;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+
+  oatpp::base::Environment::init();
+  oatpp::base::Environment::setLogger(new Logger());
+
+  /* set lockingCallback for libressl */
+  oatpp::libressl::Callbacks::setDefaultCallbacks();
+
+  int result = runLoad(arguments);
+
+  oatpp::base::Environment::setLogger(nullptr);
+  oatpp::base::Environment::destroy();
+
+  return result;
+}
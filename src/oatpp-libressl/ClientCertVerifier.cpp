@@ -0,0 +1,264 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ClientCertVerifier.hpp"
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  /* seconds until the first certificate of the chain expires. 0 - if unknown */
+  v_int64 getValidSeconds(STACK_OF(X509)* chain) {
+    v_int64 result = -1;
+    for(int i = 0; i < sk_X509_num(chain); i ++) {
+      int days;
+      int seconds;
+      if(ASN1_TIME_diff(&days, &seconds, nullptr, X509_get0_notAfter(sk_X509_value(chain, i))) != 1) {
+        return 0;
+      }
+      v_int64 valid = (v_int64) days * 24 * 60 * 60 + seconds;
+      if(result < 0 || valid < result) {
+        result = valid;
+      }
+    }
+    return result > 0 ? result : 0;
+  }
+
+}
+
+ClientCertVerifier::ClientCertVerifier()
+  : m_verifyDepth(-1)
+  , m_generation(0)
+  , m_cacheCapacity(DEFAULT_CACHE_CAPACITY)
+  , m_cacheMaxAge(DEFAULT_CACHE_MAX_AGE)
+  , m_cacheHits(0)
+  , m_cacheMisses(0)
+{}
+
+std::shared_ptr<ClientCertVerifier> ClientCertVerifier::createShared() {
+  return std::make_shared<ClientCertVerifier>();
+}
+
+void ClientCertVerifier::setCaMem(const oatpp::String& pem) {
+
+  if(!pem) {
+    throw std::runtime_error("[oatpp::libressl::ClientCertVerifier::setCaMem()]: Error. PEM is null.");
+  }
+
+  std::shared_ptr<X509_STORE> store(X509_STORE_new(), X509_STORE_free);
+  BIO* bio = BIO_new_mem_buf(pem->getData(), pem->getSize());
+
+  v_int32 count = 0;
+  X509* cert;
+  while((cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) != nullptr) {
+    if(X509_STORE_add_cert(store.get(), cert) == 1) {
+      count ++;
+    }
+    X509_free(cert);
+  }
+  BIO_free(bio);
+  ERR_clear_error();
+
+  if(count == 0) {
+    throw std::runtime_error("[oatpp::libressl::ClientCertVerifier::setCaMem()]: Error. No CA certificates loaded.");
+  }
+
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_store = store;
+  m_generation ++;
+  m_lru.clear();
+  m_cache.clear();
+
+}
+
+void ClientCertVerifier::setCaFile(const oatpp::String& path) {
+  std::ifstream file(path->c_str(), std::ios::in | std::ios::binary);
+  if(!file) {
+    throw std::runtime_error("[oatpp::libressl::ClientCertVerifier::setCaFile()]: Error. Can't open file.");
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  setCaMem(oatpp::String(buffer.str().data(), (v_int32) buffer.str().size(), true));
+}
+
+void ClientCertVerifier::setVerifyDepth(v_int32 depth) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_verifyDepth = depth;
+  m_generation ++;
+  m_lru.clear();
+  m_cache.clear();
+}
+
+void ClientCertVerifier::setCache(v_int32 capacity, v_int64 maxAgeSeconds) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_cacheCapacity = capacity;
+  m_cacheMaxAge = maxAgeSeconds;
+  m_lru.clear();
+  m_cache.clear();
+}
+
+void ClientCertVerifier::invalidate() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_generation ++;
+  m_lru.clear();
+  m_cache.clear();
+}
+
+bool ClientCertVerifier::lookup(const std::string& fingerprint, v_int64 now) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  auto it = m_cache.find(fingerprint);
+  if(it == m_cache.end()) {
+    return false;
+  }
+  if(it->second.expiresAt <= now) {
+    m_lru.erase(it->second.position);
+    m_cache.erase(it);
+    return false;
+  }
+  m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+  return true;
+}
+
+void ClientCertVerifier::insert(const std::string& fingerprint, v_int64 expiresAt, v_int64 generation) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if(generation != m_generation || m_cacheCapacity <= 0 || m_cache.find(fingerprint) != m_cache.end()) {
+    return;
+  }
+  while(m_cache.size() >= (size_t) m_cacheCapacity) {
+    m_cache.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+  m_lru.push_front(fingerprint);
+  m_cache[fingerprint] = {m_lru.begin(), expiresAt};
+}
+
+oatpp::String ClientCertVerifier::verifyChain(struct tls* tlsHandle, const std::shared_ptr<X509_STORE>& store, v_int32 depth, v_int64& validSeconds) {
+
+  validSeconds = 0;
+
+  size_t length;
+  const uint8_t* pem = tls_peer_cert_chain_pem(tlsHandle, &length);
+  if(pem == nullptr) {
+    return "Can't get peer certificate chain";
+  }
+
+  /* libtls puts peer certificate first in chain */
+  BIO* bio = BIO_new_mem_buf(pem, (int) length);
+  X509* leaf = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr);
+  STACK_OF(X509)* intermediates = sk_X509_new_null();
+  X509* cert;
+  while((cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) != nullptr) {
+    sk_X509_push(intermediates, cert);
+  }
+  BIO_free(bio);
+  ERR_clear_error();
+
+  oatpp::String error;
+
+  if(leaf == nullptr) {
+    error = "Can't parse peer certificate";
+  } else {
+    X509_STORE_CTX* context = X509_STORE_CTX_new();
+    if(context == nullptr || X509_STORE_CTX_init(context, store.get(), leaf, intermediates) != 1) {
+      error = "Can't initialize certificate verification context";
+    } else {
+      X509_STORE_CTX_set_purpose(context, X509_PURPOSE_SSL_CLIENT);
+      if(depth >= 0) {
+        X509_STORE_CTX_set_depth(context, depth);
+      }
+      if(X509_verify_cert(context) != 1) {
+        error = X509_verify_cert_error_string(X509_STORE_CTX_get_error(context));
+      } else {
+        validSeconds = getValidSeconds(X509_STORE_CTX_get0_chain(context));
+      }
+    }
+    X509_STORE_CTX_free(context);
+    X509_free(leaf);
+    ERR_clear_error();
+  }
+
+  sk_X509_pop_free(intermediates, X509_free);
+
+  return error;
+
+}
+
+oatpp::String ClientCertVerifier::verify(struct tls* tlsHandle) {
+
+  if(tls_peer_cert_provided(tlsHandle) != 1) {
+    return nullptr;
+  }
+
+  std::shared_ptr<X509_STORE> store;
+  v_int32 depth;
+  v_int64 generation;
+  v_int64 maxAge;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    store = m_store;
+    depth = m_verifyDepth;
+    generation = m_generation;
+    maxAge = m_cacheMaxAge;
+  }
+
+  if(!store) {
+    return "Client CA is not set";
+  }
+
+  v_int64 now = (v_int64) std::time(nullptr);
+  const char* hash = tls_peer_cert_hash(tlsHandle);
+  std::string fingerprint(hash != nullptr ? hash : "");
+
+  if(!fingerprint.empty() && lookup(fingerprint, now)) {
+    m_cacheHits ++;
+    return nullptr;
+  }
+
+  m_cacheMisses ++;
+
+  v_int64 validSeconds;
+  auto error = verifyChain(tlsHandle, store, depth, validSeconds);
+  if(error) {
+    return error;
+  }
+
+  if(!fingerprint.empty() && validSeconds > 0) {
+    insert(fingerprint, now + (validSeconds < maxAge ? validSeconds : maxAge), generation);
+  }
+
+  return nullptr;
+
+}
+
+}}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_ClientCertVerifier_hpp
+#define oatpp_libressl_ClientCertVerifier_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <openssl/x509_vfy.h>
+#include <tls.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Verifier of client certificate chains for mutual TLS.
+ * Chains are verified against the client CA set with libcrypto after the handshake.
+ * Fingerprints of verified leaf certificates are kept in a bounded LRU cache, so that repeat clients
+ * skip chain building. Cache entry expires with the first expiring certificate of the verified chain
+ * or after `maxAgeSeconds`, whichever comes first.
+ * Cache is invalidated when CA set or verify depth is changed.<br>
+ * Only the chain verification is cached - client still proves possession of the private key on each handshake.
+ * Used via &id:oatpp::libressl::Config::setClientAuth;.
+ */
+class ClientCertVerifier {
+public:
+  /**
+   * Default capacity of verified-chain cache.
+   */
+  static constexpr v_int32 DEFAULT_CACHE_CAPACITY = 1024;
+
+  /**
+   * Default max age of verified-chain cache entry in seconds.
+   */
+  static constexpr v_int64 DEFAULT_CACHE_MAX_AGE = 3600;
+private:
+
+  struct CacheEntry {
+    std::list<std::string>::iterator position;
+    v_int64 expiresAt;
+  };
+
+private:
+  std::mutex m_lock;
+  std::shared_ptr<X509_STORE> m_store;
+  v_int32 m_verifyDepth;
+  v_int64 m_generation;
+  v_int32 m_cacheCapacity;
+  v_int64 m_cacheMaxAge;
+  std::list<std::string> m_lru;
+  std::unordered_map<std::string, CacheEntry> m_cache;
+  std::atomic<v_int64> m_cacheHits;
+  std::atomic<v_int64> m_cacheMisses;
+private:
+  bool lookup(const std::string& fingerprint, v_int64 now);
+  void insert(const std::string& fingerprint, v_int64 expiresAt, v_int64 generation);
+  oatpp::String verifyChain(struct tls* tlsHandle, const std::shared_ptr<X509_STORE>& store, v_int32 depth, v_int64& validSeconds);
+public:
+
+  /**
+   * Constructor.
+   */
+  ClientCertVerifier();
+
+  /**
+   * Create shared ClientCertVerifier.
+   * @return - `std::shared_ptr` to ClientCertVerifier.
+   */
+  static std::shared_ptr<ClientCertVerifier> createShared();
+
+  /**
+   * Set client CA set from PEM. Replaces previous CA set and invalidates the cache.
+   * Can be called at any time - ex.: to reload CA bundle without restarting server.
+   * @param pem - PEM encoded CA certificates.
+   * @throws - `std::runtime_error` if no certificates could be loaded.
+   */
+  void setCaMem(const oatpp::String& pem);
+
+  /**
+   * Set client CA set from file. Same as &l:ClientCertVerifier::setCaMem ();.
+   * @param path - path to file with PEM encoded CA certificates.
+   * @throws - `std::runtime_error` if file can't be read or no certificates could be loaded.
+   */
+  void setCaFile(const oatpp::String& path);
+
+  /**
+   * Set max depth of certificate chain. Invalidates the cache.
+   * @param depth - max depth. Negative value - libcrypto default.
+   */
+  void setVerifyDepth(v_int32 depth);
+
+  /**
+   * Configure verified-chain cache. Clears the cache.
+   * @param capacity - max number of cached fingerprints. `0` - disable cache.
+   * @param maxAgeSeconds - max age of cache entry in seconds.
+   */
+  void setCache(v_int32 capacity, v_int64 maxAgeSeconds);
+
+  /**
+   * Remove all entries from the verified-chain cache.
+   */
+  void invalidate();
+
+  /**
+   * Verify peer certificate chain of the handshaked connection.
+   * Connection without peer certificate passes - whether certificate is required is enforced by libtls.
+   * @param tlsHandle - `struct tls*`.
+   * @return - `nullptr` if verified. Error message otherwise.
+   */
+  oatpp::String verify(struct tls* tlsHandle);
+
+  /**
+   * Number of verifications served from cache.
+   * @return - number of cache hits.
+   */
+  v_int64 getCacheHits() {
+    return m_cacheHits.load();
+  }
+
+  /**
+   * Number of verifications which required chain building.
+   * @return - number of cache misses.
+   */
+  v_int64 getCacheMisses() {
+    return m_cacheMisses.load();
+  }
+
+};
+
+}}
+
+#endif /* oatpp_libressl_ClientCertVerifier_hpp */
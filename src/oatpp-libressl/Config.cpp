@@ -24,10 +24,58 @@
 
 #include "Config.hpp"
 
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+  #include <asm/hwcap.h>
+  #include <sys/auxv.h>
+#endif
+
 namespace oatpp { namespace libressl {
 
+namespace {
+
+  /* TLS 1.3 suites are named with LibreSSL's "AEAD-" prefix */
+
+  const char* const CIPHERS_AES_GCM =
+    "AEAD-AES128-GCM-SHA256:AEAD-AES256-GCM-SHA384:AEAD-CHACHA20-POLY1305-SHA256:"
+    "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305";
+
+  const char* const CIPHERS_CHACHA20 =
+    "AEAD-CHACHA20-POLY1305-SHA256:AEAD-AES128-GCM-SHA256:AEAD-AES256-GCM-SHA384:"
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305:"
+    "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384";
+
+  const char* const ECDHE_CURVES = "X25519,P-256,P-384";
+
+  bool detectHardwareAes() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+      return false;
+    }
+    return (ecx & bit_AES) != 0 && (ecx & bit_PCLMUL) != 0;
+#elif defined(__aarch64__) && defined(__linux__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    return (hwcap & HWCAP_AES) != 0 && (hwcap & HWCAP_PMULL) != 0;
+#elif defined(__aarch64__) && defined(__APPLE__)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+}
+
 Config::Config()
   : m_config(tls_config_new())
+  , m_clientAuth(CLIENT_AUTH_NONE)
+  , m_clientCertVerifier(ClientCertVerifier::createShared())
 {}
 
 std::shared_ptr<Config> Config::createShared() {
@@ -64,6 +112,127 @@ Config::~Config(){
   tls_config_free(m_config);
 }
 
+bool Config::hasHardwareAes() {
+  static const bool result = detectHardwareAes();
+  return result;
+}
+
+void Config::setPreset(CipherPreset ciphers, ProtocolProfile protocols) {
+
+  if(ciphers == CIPHERS_AUTO) {
+    ciphers = hasHardwareAes() ? CIPHERS_AES_GCM_FIRST : CIPHERS_CHACHA20_FIRST;
+  }
+
+  uint32_t versions;
+  switch(protocols) {
+    case PROTOCOLS_TLS12_ONLY: versions = TLS_PROTOCOL_TLSv1_2; break;
+#ifdef TLS_PROTOCOL_TLSv1_3
+    case PROTOCOLS_TLS13_ONLY: versions = TLS_PROTOCOL_TLSv1_3; break;
+    default: versions = TLS_PROTOCOL_TLSv1_2 | TLS_PROTOCOL_TLSv1_3; break;
+#else
+    case PROTOCOLS_TLS13_ONLY:
+      throw std::runtime_error("[oatpp::libressl::Config::setPreset()]: TLS 1.3 is not supported by this libtls");
+    default: versions = TLS_PROTOCOL_TLSv1_2; break;
+#endif
+  }
+
+  if(tls_config_set_protocols(m_config, versions) < 0) {
+    throw std::runtime_error("[oatpp::libressl::Config::setPreset()]: failed call to tls_config_set_protocols()");
+  }
+
+  if(tls_config_set_ciphers(m_config, ciphers == CIPHERS_AES_GCM_FIRST ? CIPHERS_AES_GCM : CIPHERS_CHACHA20) < 0) {
+    throw std::runtime_error("[oatpp::libressl::Config::setPreset()]: failed call to tls_config_set_ciphers()");
+  }
+
+  if(tls_config_set_ecdhecurves(m_config, ECDHE_CURVES) < 0) {
+    throw std::runtime_error("[oatpp::libressl::Config::setPreset()]: failed call to tls_config_set_ecdhecurves()");
+  }
+
+  tls_config_prefer_ciphers_server(m_config);
+
+}
+
+void Config::setAlpnProtocols(const std::list<oatpp::String>& protocols) {
+
+  std::string alpn;
+  for(auto& protocol : protocols) {
+    if(!alpn.empty()) {
+      alpn += ",";
+    }
+    alpn.append((const char*) protocol->getData(), protocol->getSize());
+  }
+
+  if(tls_config_set_alpn(m_config, alpn.c_str()) < 0) {
+    throw std::runtime_error("[oatpp::libressl::Config::setAlpnProtocols()]: failed call to tls_config_set_alpn()");
+  }
+
+}
+
+void Config::setClientAuth(ClientAuth mode) {
+
+  if(mode == m_clientAuth) {
+    return;
+  }
+
+  switch(mode) {
+    case CLIENT_AUTH_OPTIONAL: tls_config_verify_client_optional(m_config); break;
+    case CLIENT_AUTH_REQUIRED: tls_config_verify_client(m_config); break;
+    case CLIENT_AUTH_NONE:
+      /* libtls can't stop requesting client certificate and verifying chains was turned off for it */
+      throw std::runtime_error("[oatpp::libressl::Config::setClientAuth()]: Error. Client auth can't be disabled once enabled.");
+    default:
+      throw std::runtime_error("[oatpp::libressl::Config::setClientAuth()]: Error. Unknown client auth mode.");
+  }
+
+  m_clientAuth = mode;
+
+  /* libtls only requests the certificate. Chain is verified by ClientCertVerifier after the handshake */
+  if(getClientCertVerifier()) {
+    tls_config_insecure_noverifycert(m_config);
+  }
+
+}
+
+Config::ClientAuth Config::getClientAuth() {
+  return m_clientAuth;
+}
+
+void Config::setClientCaFile(const oatpp::String& caFile) {
+  m_clientCertVerifier->setCaFile(caFile);
+}
+
+void Config::setClientCaMem(const oatpp::String& pem) {
+  m_clientCertVerifier->setCaMem(pem);
+}
+
+void Config::setClientVerifyDepth(v_int32 depth) {
+  m_clientCertVerifier->setVerifyDepth(depth);
+}
+
+void Config::setVerifiedChainCache(v_int32 capacity, v_int64 maxAgeSeconds) {
+  m_clientCertVerifier->setCache(capacity, maxAgeSeconds);
+}
+
+std::shared_ptr<ClientCertVerifier> Config::getClientCertVerifier() {
+  if(m_clientAuth == CLIENT_AUTH_NONE) {
+    return nullptr;
+  }
+  return m_clientCertVerifier;
+}
+
+void Config::setSessionStore(const std::shared_ptr<SessionStore>& store) {
+  m_sessionKeys = store->configure(m_config);
+  m_sessionStore = store;
+}
+
+std::shared_ptr<SessionStore> Config::getSessionStore() {
+  return m_sessionStore;
+}
+
+std::shared_ptr<SessionStore::ConfigKeys> Config::getSessionKeys() {
+  return m_sessionKeys;
+}
+
 Config::TLSConfig Config::getTLSConfig() {
   return m_config;
 }
@@ -25,9 +25,13 @@
 #ifndef oatpp_libressl_Config_hpp
 #define oatpp_libressl_Config_hpp
 
+#include "oatpp-libressl/ClientCertVerifier.hpp"
+#include "oatpp-libressl/SessionStore.hpp"
+
 #include "oatpp/core/Types.hpp"
 
 #include <tls.h>
+#include <list>
 #include <memory>
 
 namespace oatpp { namespace libressl {
@@ -38,8 +42,79 @@ namespace oatpp { namespace libressl {
 class Config {
 public:
   typedef struct tls_config* TLSConfig;
+public:
+
+  /**
+   * Client certificate verification mode (server only).
+   */
+  enum ClientAuth : v_int32 {
+
+    /**
+     * Client certificate is not requested.
+     */
+    CLIENT_AUTH_NONE = 0,
+
+    /**
+     * Client certificate is requested. If provided - it must be valid.
+     */
+    CLIENT_AUTH_OPTIONAL = 1,
+
+    /**
+     * Client certificate is required and must be valid.
+     */
+    CLIENT_AUTH_REQUIRED = 2
+
+  };
+
+  /**
+   * Preference order of cipher suites. See &l:Config::setPreset ();.
+   */
+  enum CipherPreset : v_int32 {
+
+    /**
+     * AES-GCM first if CPU has AES hardware acceleration (see &l:Config::hasHardwareAes ();), ChaCha20-Poly1305 first otherwise.
+     */
+    CIPHERS_AUTO = 0,
+
+    /**
+     * AES-GCM first. Fastest with AES-NI/CLMUL (x86) or ARMv8 Crypto Extensions.
+     */
+    CIPHERS_AES_GCM_FIRST = 1,
+
+    /**
+     * ChaCha20-Poly1305 first. Fastest on CPUs without AES hardware acceleration.
+     */
+    CIPHERS_CHACHA20_FIRST = 2
+
+  };
+
+  /**
+   * Set of enabled protocol versions. See &l:Config::setPreset ();.
+   */
+  enum ProtocolProfile : v_int32 {
+
+    /**
+     * TLS 1.3 and TLS 1.2. TLS 1.3 is negotiated when peer supports it.
+     */
+    PROTOCOLS_TLS13_PREFERRED = 0,
+
+    /**
+     * TLS 1.2 only.
+     */
+    PROTOCOLS_TLS12_ONLY = 1,
+
+    /**
+     * TLS 1.3 only.
+     */
+    PROTOCOLS_TLS13_ONLY = 2
+
+  };
 private:
   TLSConfig m_config;
+  ClientAuth m_clientAuth;
+  std::shared_ptr<ClientCertVerifier> m_clientCertVerifier;
+  std::shared_ptr<SessionStore> m_sessionStore;
+  std::shared_ptr<SessionStore::ConfigKeys> m_sessionKeys;
 public:
   /**
    * Constructor.
@@ -66,6 +141,102 @@ public:
    */
   virtual ~Config();
 
+  /**
+   * Check if CPU has AES-GCM hardware acceleration - AES-NI and CLMUL on x86, AES and PMULL on ARMv8.
+   * Detected once.
+   * @return - `true` if AES-GCM is accelerated.
+   */
+  static bool hasHardwareAes();
+
+  /**
+   * Set cipher suites (in preference order), ECDHE curves (X25519 first) and protocol versions.
+   * Server cipher preference is enabled, so the order is honored for all clients.
+   * @param ciphers - &l:Config::CipherPreset;.
+   * @param protocols - &l:Config::ProtocolProfile;.
+   * @throws - `std::runtime_error` if preset can't be applied.
+   */
+  void setPreset(CipherPreset ciphers, ProtocolProfile protocols = PROTOCOLS_TLS13_PREFERRED);
+
+  /**
+   * Set protocols to negotiate via ALPN, in order of preference. Ex.: `{"h2", "http/1.1"}`.
+   * For server - protocols it accepts. For client - protocols it offers.
+   * Negotiated protocol is available via &id:oatpp::libressl::Connection::getAlpnProtocol;.
+   * @param protocols - list of protocol names.
+   * @throws - `std::runtime_error` if protocols can't be set.
+   */
+  void setAlpnProtocols(const std::list<oatpp::String>& protocols);
+
+  /**
+   * Set client certificate verification mode (server only). Must be called before the server is created.<br>
+   * Chains are verified by &id:oatpp::libressl::ClientCertVerifier; instead of libtls, so that verified chains
+   * can be cached and client CA set can be reloaded without reconfiguring the server.
+   * Client CA must be set via &l:Config::setClientCaFile (); or &l:Config::setClientCaMem ();.<br>
+   * Mode may be switched between `CLIENT_AUTH_OPTIONAL` and `CLIENT_AUTH_REQUIRED`, but once enabled
+   * client auth can't be switched back to `CLIENT_AUTH_NONE` - create new config instead.
+   * @param mode - &l:Config::ClientAuth;.
+   * @throws - `std::runtime_error` on attempt to disable client auth.
+   */
+  void setClientAuth(ClientAuth mode);
+
+  /**
+   * Get client certificate verification mode.
+   * @return - &l:Config::ClientAuth;.
+   */
+  ClientAuth getClientAuth();
+
+  /**
+   * Load (or reload) client CA bundle from file. Invalidates verified-chain cache.
+   * @param caFile - path to file with PEM encoded CA certificates.
+   * @throws - `std::runtime_error` if CA can't be loaded.
+   */
+  void setClientCaFile(const oatpp::String& caFile);
+
+  /**
+   * Load (or reload) client CA bundle from memory. Invalidates verified-chain cache.
+   * @param pem - PEM encoded CA certificates.
+   * @throws - `std::runtime_error` if CA can't be loaded.
+   */
+  void setClientCaMem(const oatpp::String& pem);
+
+  /**
+   * Set max depth of client certificate chain.
+   * @param depth - max depth.
+   */
+  void setClientVerifyDepth(v_int32 depth);
+
+  /**
+   * Configure cache of verified client certificate chains.
+   * @param capacity - max number of cached leaf-certificate fingerprints. `0` - disable cache.
+   * @param maxAgeSeconds - max age of cache entry in seconds.
+   */
+  void setVerifiedChainCache(v_int32 capacity, v_int64 maxAgeSeconds);
+
+  /**
+   * Get &id:oatpp::libressl::ClientCertVerifier;.
+   * @return - `std::shared_ptr` to ClientCertVerifier or `nullptr` if client auth is not enabled.
+   */
+  std::shared_ptr<ClientCertVerifier> getClientCertVerifier();
+
+  /**
+   * Share session resumption state with other server processes (server only). Must be called before the server is created.
+   * Server connection providers sync ticket keys from the store on accept.
+   * @param store - &id:oatpp::libressl::SessionStore;.
+   * @throws - `std::runtime_error` on libtls error.
+   */
+  void setSessionStore(const std::shared_ptr<SessionStore>& store);
+
+  /**
+   * Get &id:oatpp::libressl::SessionStore;.
+   * @return - `std::shared_ptr` to SessionStore or `nullptr` if not set.
+   */
+  std::shared_ptr<SessionStore> getSessionStore();
+
+  /**
+   * Get ticket keys state of this config synced from &id:oatpp::libressl::SessionStore;.
+   * @return - `std::shared_ptr` to &id:oatpp::libressl::SessionStore::ConfigKeys; or `nullptr` if store is not set.
+   */
+  std::shared_ptr<SessionStore::ConfigKeys> getSessionKeys();
+
   /**
    * Get underlying tls_config.
    * @return - `tls_config*`.
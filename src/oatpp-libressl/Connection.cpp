@@ -24,13 +24,57 @@
 
 #include "Connection.hpp"
 
+#include <chrono>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <unistd.h>
+#include <sys/socket.h>
 
 namespace oatpp { namespace libressl {
   
 Connection::Connection(TLSHandle tlsHandle, data::v_io_handle handle)
   : m_tlsHandle(tlsHandle)
   , m_handle(handle)
+  , m_handshakeStartedAt(0)
+  , m_handshakeMicros(0)
+  , m_handshakeDone(false)
+  , m_fullDuplex(false)
+  , m_blockingHandle(false)
+  , m_tlsLock(false)
+  , m_certRejected(false)
+  , m_writeClosed(false)
+  , m_throttledSince(0)
+  , m_throttledMicros(0)
+  , m_pendingWriteGrant(0)
+  , m_readBufferSize(0)
+  , m_readPosition(0)
+  , m_readLimit(0)
+{
+}
+
+Connection::Connection(TLSHandle tlsHandle, const std::shared_ptr<oatpp::data::stream::IOStream>& stream)
+  : m_tlsHandle(tlsHandle)
+  , m_handle(-1)
+  , m_stream(stream)
+  , m_handshakeStartedAt(0)
+  , m_handshakeMicros(0)
+  , m_handshakeDone(false)
+  , m_fullDuplex(false)
+  , m_blockingHandle(false)
+  , m_tlsLock(false)
+  , m_certRejected(false)
+  , m_writeClosed(false)
+  , m_throttledSince(0)
+  , m_throttledMicros(0)
+  , m_pendingWriteGrant(0)
+  , m_readBufferSize(0)
+  , m_readPosition(0)
+  , m_readLimit(0)
 {
 }
 
@@ -39,37 +83,523 @@ Connection::~Connection(){
   tls_free(m_tlsHandle);
 }
 
+ssize_t Connection::readCallback(struct tls* tlsHandle, void* buff, size_t count, void* cbArg) {
+  auto stream = static_cast<oatpp::data::stream::IOStream*>(cbArg);
+  auto result = stream->read(buff, count);
+  if(result >= 0) {
+    return result;
+  }
+  if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+    return TLS_WANT_POLLIN;
+  }
+  /* libtls reports I/O error by errno - see ErrorStats::classify() */
+  errno = (result == data::IOError::BROKEN_PIPE) ? EPIPE : EIO;
+  return -1;
+}
+
+ssize_t Connection::writeCallback(struct tls* tlsHandle, const void* buff, size_t count, void* cbArg) {
+  auto stream = static_cast<oatpp::data::stream::IOStream*>(cbArg);
+  auto result = stream->write(buff, count);
+  if(result > 0) {
+    return result;
+  }
+  if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+    return TLS_WANT_POLLOUT;
+  }
+  errno = (result == data::IOError::BROKEN_PIPE) ? EPIPE : EIO;
+  return -1;
+}
+
+data::v_io_size Connection::handleError(data::v_io_size result, const char* tag) {
+  if (result == TLS_WANT_POLLIN || result == TLS_WANT_POLLOUT) {
+    return data::IOError::WAIT_RETRY;
+  }
+  ErrorStats::Type type;
+  bool hasMessage = captureError(type);
+  ErrorStats::onError(type, tag, hasMessage ? m_lastError.c_str() : nullptr);
+  return result;
+}
+
+bool Connection::captureError(ErrorStats::Type& type) {
+  if(m_certRejected) {
+    type = ErrorStats::HANDSHAKE;
+    return true;
+  }
+  type = ErrorStats::classify(errno, m_handshakeDone);
+  auto error = tls_error(m_tlsHandle);
+  if(error) {
+    /* reuses capacity - no allocation on repeated errors */
+    m_lastError.assign(error);
+    return true;
+  }
+  return false;
+}
+
+ssize_t Connection::doHandshake() {
+  if(m_certRejected) {
+    return -1;
+  }
+#ifdef OATPP_LIBRESSL_TRACE
+  traceFirstByte();
+#endif
+  if(m_handshakeStartedAt == 0) {
+    m_handshakeStartedAt = oatpp::base::Environment::getMicroTickCount();
+  }
+  errno = 0;
+  ssize_t result;
+  if(m_sessionKeys) {
+    m_sessionKeys->lockShared();
+    result = tls_handshake(m_tlsHandle);
+    m_sessionKeys->unlockShared();
+  } else {
+    result = tls_handshake(m_tlsHandle);
+  }
+  if(result == 0 && m_certVerifier) {
+    auto error = m_certVerifier->verify(m_tlsHandle);
+    if(error) {
+      m_lastError = "Peer certificate verification failed: " + error->std_str();
+      m_certRejected = true;
+      return -1;
+    }
+  }
+  if(result == 0) {
+    m_handshakeMicros = oatpp::base::Environment::getMicroTickCount() - m_handshakeStartedAt;
+    m_handshakeDone = true;
+    OATPP_LIBRESSL_TRACE_EVENT(m_traceSpan, HANDSHAKE_DONE);
+  }
+  return result;
+}
+
+#ifdef OATPP_LIBRESSL_TRACE
+void Connection::traceFirstByte() {
+
+  if(m_handle < 0 || (m_traceSpan.recorded.load(std::memory_order_relaxed) & (1 << Trace::FIRST_BYTE)) != 0) {
+    return;
+  }
+
+  /* never wait here - the call may hold m_tlsLock, and a peer which sends nothing would park the worker.
+   * Blocking connection waits inside tls_handshake() - arrival of the first byte isn't seen then */
+  v_char8 byte;
+  auto result = recv(m_handle, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+
+  /* nothing yet, EOF or error */
+  if(result <= 0) {
+    return;
+  }
+
+  OATPP_LIBRESSL_TRACE_EVENT(m_traceSpan, FIRST_BYTE);
+
+}
+#endif
+
+data::v_io_size Connection::callFullDuplex(Operation operation, void* buff, data::v_io_size count, const char* tag) {
+
+  v_int32 waits = 0;
+
+  while(true) {
+
+    ssize_t result = 0;
+    bool failed = false;
+    ErrorStats::Type errorType = ErrorStats::OTHER;
+    std::string errorMessage;
+
+    {
+      oatpp::concurrency::SpinLock lock(m_tlsLock);
+      if(!m_handshakeDone) {
+        result = doHandshake();
+      }
+      if(result == 0) {
+        errno = 0;
+        switch(operation) {
+          case READ: result = tls_read(m_tlsHandle, buff, count); break;
+          case WRITE: result = tls_write(m_tlsHandle, buff, count); break;
+          case CLOSE_WRITE:
+            result = tls_close(m_tlsHandle);
+            m_writeClosed = (result == 0);
+            break;
+          default: break;
+        }
+      }
+      if(result < 0 && result != TLS_WANT_POLLIN && result != TLS_WANT_POLLOUT) {
+        /* errno and the message belong to this call - take them before the other thread makes its call */
+        failed = true;
+        if(captureError(errorType)) {
+          errorMessage = m_lastError;
+        }
+      }
+    }
+
+    if(failed) {
+      ErrorStats::onError(errorType, tag, errorMessage.empty() ? nullptr : errorMessage.c_str());
+      return result;
+    }
+
+    if(result >= 0) {
+      return result;
+    }
+
+    if(!m_blockingHandle) {
+      return data::IOError::WAIT_RETRY;
+    }
+
+    if(m_handle < 0) {
+      /* nothing to poll for the stream - back off so that the blocking caller doesn't spin */
+      if(waits < 16) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(waits < 64 ? 100 : 1000));
+      }
+      waits ++;
+      continue;
+    }
+
+    /* wait for the socket outside of the lock.
+     * The other thread may take the awaited bytes or finish the handshake meanwhile - then the socket
+     * never becomes ready for this call, so the wait is limited and libtls call is retried */
+    struct pollfd pfd;
+    pfd.fd = m_handle;
+    pfd.events = (result == TLS_WANT_POLLIN) ? POLLIN : POLLOUT;
+    pfd.revents = 0;
+    poll(&pfd, 1, FULL_DUPLEX_POLL_MILLIS);
+
+  }
+
+}
+
+data::v_io_size Connection::handshake() {
+  if(m_handshakeDone) {
+    return 0;
+  }
+  if(m_fullDuplex) {
+    return callFullDuplex(HANDSHAKE, nullptr, 0, "[oatpp::libressl::Connection::handshake()]");
+  }
+  auto result = doHandshake();
+  if(result == 0) {
+    return 0;
+  }
+  return handleError(result, "[oatpp::libressl::Connection::handshake()]");
+}
+
+void Connection::setCertVerifier(const std::shared_ptr<ClientCertVerifier>& verifier) {
+  m_certVerifier = verifier;
+}
+
+void Connection::setSessionKeys(const std::shared_ptr<SessionStore::ConfigKeys>& keys) {
+  m_sessionKeys = keys;
+}
+
+void Connection::setWriteLimiters(const std::shared_ptr<RateLimiter>& limiter, const std::shared_ptr<RateLimiter>& sharedLimiter) {
+  m_writeLimiter = limiter;
+  m_sharedWriteLimiter = sharedLimiter;
+}
+
+std::shared_ptr<const TlsInfo> Connection::getTlsInfo() {
+  if(!m_handshakeDone) {
+    return nullptr;
+  }
+  if(m_fullDuplex) {
+    oatpp::concurrency::SpinLock lock(m_tlsLock);
+    if(!m_tlsInfo) {
+      m_tlsInfo = TlsInfo::createShared(m_tlsHandle, m_handshakeMicros);
+    }
+    return m_tlsInfo;
+  }
+  if(!m_tlsInfo) {
+    m_tlsInfo = TlsInfo::createShared(m_tlsHandle, m_handshakeMicros);
+  }
+  return m_tlsInfo;
+}
+
+oatpp::String Connection::getLastError() {
+  std::string error;
+  if(m_fullDuplex) {
+    oatpp::concurrency::SpinLock lock(m_tlsLock);
+    error = m_lastError;
+  } else {
+    error = m_lastError;
+  }
+  if(error.empty()) {
+    return nullptr;
+  }
+  return oatpp::String(error.data(), (v_int32) error.size(), true);
+}
+
+void Connection::setFullDuplex(bool enabled) {
+
+  if(m_fullDuplex == enabled) {
+    return;
+  }
+
+  m_fullDuplex = enabled;
+
+  if(m_handle >= 0) {
+    int flags = fcntl(m_handle, F_GETFL);
+    if(enabled) {
+      m_blockingHandle = (flags & O_NONBLOCK) == 0;
+      fcntl(m_handle, F_SETFL, flags | O_NONBLOCK);
+    } else if(m_blockingHandle) {
+      fcntl(m_handle, F_SETFL, flags & ~O_NONBLOCK);
+    }
+  } else {
+    /* stream can't be polled - full-duplex calls wait for it themselves */
+    m_blockingHandle = enabled;
+  }
+
+}
+
+oatpp::String Connection::getAlpnProtocol() {
+  auto info = getTlsInfo();
+  if(info) {
+    return info->alpn;
+  }
+  return nullptr;
+}
+
 data::v_io_size Connection::write(const void *buff, data::v_io_size count){
+  if(m_writeLimiter || m_sharedWriteLimiter) {
+    return writeLimited(buff, count);
+  }
+  return writeTls(buff, count);
+}
+
+bool Connection::isBlocking() {
+  if(m_fullDuplex) {
+    return m_blockingHandle;
+  }
+  if(m_handle < 0) {
+    return false;
+  }
+  return (fcntl(m_handle, F_GETFL) & O_NONBLOCK) == 0;
+}
+
+v_int64 Connection::acquireWrite(v_int64 count) {
+  v_int64 allowed = count;
+  if(m_writeLimiter) {
+    allowed = m_writeLimiter->acquire(allowed);
+    if(allowed == 0) {
+      return 0;
+    }
+  }
+  if(m_sharedWriteLimiter) {
+    v_int64 shared = m_sharedWriteLimiter->acquire(allowed);
+    if(shared < allowed && m_writeLimiter) {
+      m_writeLimiter->refund(allowed - shared);
+    }
+    allowed = shared;
+  }
+  return allowed;
+}
+
+data::v_io_size Connection::writeLimited(const void *buff, data::v_io_size count) {
+
+  v_int64 allowed;
+
+  /* libtls requires retry of the pending record with the same length - reuse the grant of the interrupted write */
+  if(m_pendingWriteGrant > 0) {
+    allowed = m_pendingWriteGrant < count ? m_pendingWriteGrant : count;
+  } else {
+
+    while((allowed = acquireWrite(count)) == 0) {
+
+      if(m_throttledSince == 0) {
+        m_throttledSince = oatpp::base::Environment::getMicroTickCount();
+      }
+
+      if(!isBlocking()) {
+        return data::IOError::WAIT_RETRY;
+      }
+
+      v_int64 wait = m_writeLimiter ? m_writeLimiter->getWaitMicros() : 0;
+      if(m_sharedWriteLimiter) {
+        v_int64 sharedWait = m_sharedWriteLimiter->getWaitMicros();
+        wait = sharedWait > wait ? sharedWait : wait;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(wait > 0 ? wait : 1));
+
+    }
+
+    if(m_throttledSince != 0) {
+      v_int64 micros = oatpp::base::Environment::getMicroTickCount() - m_throttledSince;
+      m_throttledSince = 0;
+      m_throttledMicros.fetch_add(micros);
+      if(m_writeLimiter) {
+        m_writeLimiter->onThrottled(micros);
+      }
+      if(m_sharedWriteLimiter) {
+        m_sharedWriteLimiter->onThrottled(micros);
+      }
+    }
+
+  }
+
+  auto result = writeTls(buff, allowed);
+
+  /* record is pending in libtls - keep the grant until the write completes */
+  if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+    m_pendingWriteGrant = allowed;
+    return result;
+  }
+
+  v_int64 unused = m_pendingWriteGrant > allowed ? m_pendingWriteGrant : allowed;
+  unused -= (result > 0 ? result : 0);
+  m_pendingWriteGrant = 0;
+  if(unused > 0) {
+    if(m_writeLimiter) {
+      m_writeLimiter->refund(unused);
+    }
+    if(m_sharedWriteLimiter) {
+      m_sharedWriteLimiter->refund(unused);
+    }
+  }
+
+  return result;
+
+}
+
+data::v_io_size Connection::writeTls(const void *buff, data::v_io_size count){
+  if(m_fullDuplex) {
+    return callFullDuplex(WRITE, const_cast<void*>(buff), count, "[oatpp::libressl::Connection::write(...)]");
+  }
+  if(!m_handshakeDone) {
+    auto result = handshake();
+    if(result != 0) {
+      return result;
+    }
+  }
+  errno = 0;
   auto result = tls_write(m_tlsHandle, buff, count);
   if(result < 0) {
-    if (result == TLS_WANT_POLLIN || result == TLS_WANT_POLLOUT) {
-      return data::IOError::WAIT_RETRY;
+    return handleError(result, "[oatpp::libressl::Connection::write(...)]");
+  }
+  return result;
+}
+
+data::v_io_size Connection::readTls(void *buff, data::v_io_size count){
+  if(m_fullDuplex) {
+    auto result = callFullDuplex(READ, buff, count, "[oatpp::libressl::Connection::read(...)]");
+    if(result > 0) {
+      OATPP_LIBRESSL_TRACE_EVENT(m_traceSpan, FIRST_APP_BYTE);
     }
-    auto error = tls_error(m_tlsHandle);
-    if(error){
-      OATPP_LOGD("[oatpp::libressl::Connection::write(...)]", "error - %s", error);
+    return result;
+  }
+  if(!m_handshakeDone) {
+    auto result = handshake();
+    if(result != 0) {
+      return result;
     }
   }
+  errno = 0;
+  auto result = tls_read(m_tlsHandle, buff, count);
+  if(result < 0) {
+    return handleError(result, "[oatpp::libressl::Connection::read(...)]");
+  }
+  if(result > 0) {
+    OATPP_LIBRESSL_TRACE_EVENT(m_traceSpan, FIRST_APP_BYTE);
+  }
+  return result;
+}
+
+data::v_io_size Connection::fillReadBuffer() {
+  if(!m_readBuffer) {
+    m_readBuffer.reset(new v_char8[m_readBufferSize]);
+  }
+  auto result = readTls(m_readBuffer.get(), m_readBufferSize);
+  if(result > 0) {
+    m_readPosition = 0;
+    m_readLimit = result;
+  }
   return result;
 }
 
 data::v_io_size Connection::read(void *buff, data::v_io_size count){
-  auto result = tls_read(m_tlsHandle, buff, count);
-  if(result < 0) {
-    if (result == TLS_WANT_POLLIN || result == TLS_WANT_POLLOUT) {
-      return data::IOError::WAIT_RETRY;
+
+  if(m_readBufferSize == 0) {
+    return readTls(buff, count);
+  }
+
+  if(m_readPosition == m_readLimit) {
+    /* large reads go directly to caller's buffer - no point to copy twice */
+    if(count >= m_readBufferSize) {
+      return readTls(buff, count);
+    }
+    auto result = fillReadBuffer();
+    if(result <= 0) {
+      return result;
     }
-    auto error = tls_error(m_tlsHandle);
-    if(error){
-      OATPP_LOGD("[oatpp::libressl::Connection::read(...)]", "error - %s", error);
+  }
+
+  data::v_io_size size = m_readLimit - m_readPosition;
+  if(size > count) {
+    size = count;
+  }
+  std::memcpy(buff, &m_readBuffer[m_readPosition], size);
+  m_readPosition += size;
+  return size;
+
+}
+
+void Connection::setReadBuffer(v_int32 size) {
+  m_readBufferSize = size > 0 ? size : 0;
+  m_readBuffer.reset();
+  m_readPosition = 0;
+  m_readLimit = 0;
+}
+
+data::v_io_size Connection::peek(const v_char8*& data) {
+
+  if(m_readBufferSize == 0) {
+    throw std::runtime_error("[oatpp::libressl::Connection::peek()]: Error. Buffered input mode is disabled. Call setReadBuffer().");
+  }
+
+  if(m_readPosition == m_readLimit) {
+    auto result = fillReadBuffer();
+    if(result <= 0) {
+      data = nullptr;
+      return result;
     }
   }
+
+  data = &m_readBuffer[m_readPosition];
+  return m_readLimit - m_readPosition;
+
+}
+
+void Connection::consume(data::v_io_size count) {
+  if(count > m_readLimit - m_readPosition) {
+    count = m_readLimit - m_readPosition;
+  }
+  if(count > 0) {
+    m_readPosition += count;
+  }
+}
+
+data::v_io_size Connection::closeWrite() {
+  if(m_fullDuplex) {
+    return callFullDuplex(CLOSE_WRITE, nullptr, 0, "[oatpp::libressl::Connection::closeWrite()]");
+  }
+  errno = 0;
+  auto result = tls_close(m_tlsHandle);
+  if(result < 0) {
+    return handleError(result, "[oatpp::libressl::Connection::closeWrite()]");
+  }
+  m_writeClosed = true;
   return result;
 }
 
 void Connection::close(){
-  tls_close(m_tlsHandle);
-  ::close(m_handle);
+  OATPP_LIBRESSL_TRACE_EVENT(m_traceSpan, CLOSE);
+  /* close_notify is already sent by closeWrite() - don't shut TLS down twice */
+  if(m_fullDuplex) {
+    oatpp::concurrency::SpinLock lock(m_tlsLock);
+    if(!m_writeClosed) {
+      tls_close(m_tlsHandle);
+    }
+  } else if(!m_writeClosed) {
+    tls_close(m_tlsHandle);
+  }
+  if(m_handle >= 0) {
+    ::close(m_handle);
+  }
 }
   
 }}
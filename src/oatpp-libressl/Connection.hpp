@@ -25,25 +25,99 @@
 #ifndef oatpp_libressl_Connection_hpp
 #define oatpp_libressl_Connection_hpp
 
+#include "oatpp-libressl/BuildConfig.hpp"
+#include "oatpp-libressl/ClientCertVerifier.hpp"
+#include "oatpp-libressl/ErrorStats.hpp"
+#include "oatpp-libressl/RateLimiter.hpp"
+#include "oatpp-libressl/SessionStore.hpp"
+#include "oatpp-libressl/TlsInfo.hpp"
+#include "oatpp-libressl/Trace.hpp"
+
 #include "oatpp/core/base/memory/ObjectPool.hpp"
+#include "oatpp/core/concurrency/SpinLock.hpp"
 #include "oatpp/core/data/stream/Stream.hpp"
 
 #include <tls.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * Number of Connection objects allocated by the pool at once.
+ * Set with `-DOATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE=<n>` CMake option.
+ */
+#ifndef OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE
+  #define OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE 32
+#endif
 
 namespace oatpp { namespace libressl {
 
 /**
  * TLS Connection implementation. Extends &id:oatpp::base::Countable; and &id:oatpp::data::stream::IOStream;.
+ * TLS runs either directly over socket handle or over arbitrary &id:oatpp::data::stream::IOStream; (libtls callback I/O).
  */
 class Connection : public oatpp::base::Countable, public oatpp::data::stream::IOStream {
 public:
   typedef struct tls* TLSHandle;
+private:
+  enum Operation : v_int32 {
+    HANDSHAKE = 0,
+    READ = 1,
+    WRITE = 2,
+    CLOSE_WRITE = 3
+  };
+  /* max time a full-duplex call waits for the socket before retrying libtls call */
+  static constexpr v_int32 FULL_DUPLEX_POLL_MILLIS = 10;
 public:
-  OBJECT_POOL(libressl_Connection_Pool, Connection, 32);
-  SHARED_OBJECT_POOL(libressl_Shared_Connection_Pool, Connection, 32);
+#ifdef OATPP_LIBRESSL_CONNECTION_POOL_THREAD_LOCAL
+  OBJECT_POOL_THREAD_LOCAL(libressl_Connection_Pool, Connection, OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE);
+  SHARED_OBJECT_POOL_THREAD_LOCAL(libressl_Shared_Connection_Pool, Connection, OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE);
+#else
+  OBJECT_POOL(libressl_Connection_Pool, Connection, OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE);
+  SHARED_OBJECT_POOL(libressl_Shared_Connection_Pool, Connection, OATPP_LIBRESSL_CONNECTION_POOL_CHUNK_SIZE);
+#endif
 private:
   TLSHandle m_tlsHandle;
   data::v_io_handle m_handle;
+  std::shared_ptr<oatpp::data::stream::IOStream> m_stream;
+  v_int64 m_handshakeStartedAt;
+  v_int64 m_handshakeMicros;
+  std::atomic<bool> m_handshakeDone;
+  std::shared_ptr<const TlsInfo> m_tlsInfo;
+  std::string m_lastError;
+  bool m_fullDuplex;
+  bool m_blockingHandle;
+  oatpp::concurrency::SpinLock::Atom m_tlsLock;
+  std::shared_ptr<ClientCertVerifier> m_certVerifier;
+  bool m_certRejected;
+  bool m_writeClosed;
+  std::shared_ptr<SessionStore::ConfigKeys> m_sessionKeys;
+  std::shared_ptr<RateLimiter> m_writeLimiter;
+  std::shared_ptr<RateLimiter> m_sharedWriteLimiter;
+  v_int64 m_throttledSince;
+  std::atomic<v_int64> m_throttledMicros;
+  v_int64 m_pendingWriteGrant;
+  std::unique_ptr<v_char8[]> m_readBuffer;
+  v_int32 m_readBufferSize;
+  data::v_io_size m_readPosition;
+  data::v_io_size m_readLimit;
+#ifdef OATPP_LIBRESSL_TRACE
+  Trace::Span m_traceSpan;
+#endif
+private:
+  data::v_io_size handleError(data::v_io_size result, const char* tag);
+  bool captureError(ErrorStats::Type& type);
+  ssize_t doHandshake();
+  data::v_io_size callFullDuplex(Operation operation, void* buff, data::v_io_size count, const char* tag);
+  data::v_io_size writeTls(const void *buff, data::v_io_size count);
+  data::v_io_size writeLimited(const void *buff, data::v_io_size count);
+  v_int64 acquireWrite(v_int64 count);
+  bool isBlocking();
+  data::v_io_size readTls(void *buff, data::v_io_size count);
+  data::v_io_size fillReadBuffer();
+#ifdef OATPP_LIBRESSL_TRACE
+  void traceFirstByte();
+#endif
 public:
   /**
    * Constructor.
@@ -51,6 +125,14 @@ public:
    * @param handle - connection handle (file descriptor). &id:oatpp::data::v_io_handle;.
    */
   Connection(TLSHandle tlsHandle, data::v_io_handle handle);
+
+  /**
+   * Constructor.
+   * @param tlsHandle - `tls*` set up with &l:Connection::readCallback (); and &l:Connection::writeCallback ();
+   * and `stream.get()` as callback argument.
+   * @param stream - underlying transport stream. &id:oatpp::data::stream::IOStream;.
+   */
+  Connection(TLSHandle tlsHandle, const std::shared_ptr<oatpp::data::stream::IOStream>& stream);
 public:
 
   /**
@@ -63,6 +145,29 @@ public:
     return libressl_Shared_Connection_Pool::allocateShared(tlsHandle, handle);
   }
 
+  /**
+   * Create shared connection over arbitrary stream.
+   * @param tlsHandle - `tls*` set up with &l:Connection::readCallback (); and &l:Connection::writeCallback ();
+   * and `stream.get()` as callback argument.
+   * @param stream - underlying transport stream. &id:oatpp::data::stream::IOStream;.
+   * @return - `std::shared_ptr` to Connection.
+   */
+  static std::shared_ptr<Connection> createShared(TLSHandle tlsHandle, const std::shared_ptr<oatpp::data::stream::IOStream>& stream){
+    return libressl_Shared_Connection_Pool::allocateShared(tlsHandle, stream);
+  }
+
+  /**
+   * libtls read callback (`tls_read_cb`) reading from &id:oatpp::data::stream::IOStream; passed as `cbArg`.
+   * Pass it to `tls_accept_cbs` or `tls_connect_cbs`.
+   */
+  static ssize_t readCallback(struct tls* tlsHandle, void* buff, size_t count, void* cbArg);
+
+  /**
+   * libtls write callback (`tls_write_cb`) writing to &id:oatpp::data::stream::IOStream; passed as `cbArg`.
+   * Pass it to `tls_accept_cbs` or `tls_connect_cbs`.
+   */
+  static ssize_t writeCallback(struct tls* tlsHandle, const void* buff, size_t count, void* cbArg);
+
   /**
    * Virtual destructor.
    */
@@ -78,6 +183,7 @@ public:
 
   /**
    * Implementation of &id:oatpp::data::stream::InputStream::read; method.
+   * In buffered input mode small reads are served from the read buffer - see &l:Connection::setReadBuffer ();.
    * @param buff - buffer to read data to.
    * @param count - buffer size.
    * @return - actual amount of bytes read.
@@ -85,7 +191,144 @@ public:
   data::v_io_size read(void *buff, data::v_io_size count) override;
 
   /**
-   * Close all handles.
+   * Enable/disable buffered input mode. Each `tls_read()` then decrypts up to `size` bytes into
+   * connection's read buffer, and small reads (ex.: HTTP headers parsed line by line) are served from it
+   * without calls to libtls. Reads of at least `size` bytes bypass the buffer.<br>
+   * Use `16384` - max TLS record payload - to take whole record at once.
+   * Buffer is allocated on first read, so idle connections don't hold it.<br>
+   * Must be called before the connection is used.
+   * @param size - buffer size in bytes. `0` - disable buffered input mode.
+   */
+  void setReadBuffer(v_int32 size);
+
+  /**
+   * Get size of read buffer.
+   * @return - size in bytes. `0` if buffered input mode is disabled.
+   */
+  v_int32 getReadBufferSize() {
+    return m_readBufferSize;
+  }
+
+  /**
+   * Get amount of plaintext in the read buffer, which is available without I/O.
+   * @return - amount of bytes.
+   */
+  data::v_io_size getBufferedSize() {
+    return m_readLimit - m_readPosition;
+  }
+
+  /**
+   * Access buffered plaintext without copying it. Reads next chunk into the read buffer if it is empty.
+   * Data stays in the buffer until &l:Connection::consume (); is called.
+   * Requires buffered input mode - see &l:Connection::setReadBuffer ();.
+   * @param data - out parameter. Pointer to buffered plaintext. Valid until next read, peek or consume.
+   * @return - amount of bytes available at `data`, or result of the failed read -
+   * `0` on EOF, &id:oatpp::data::IOError::WAIT_RETRY;, negative value on error.
+   * @throws - `std::runtime_error` if buffered input mode is disabled.
+   */
+  data::v_io_size peek(const v_char8*& data);
+
+  /**
+   * Drop bytes from the read buffer after &l:Connection::peek ();.
+   * @param count - amount of bytes. Values bigger than &l:Connection::getBufferedSize (); drop whole buffer.
+   */
+  void consume(data::v_io_size count);
+
+  /**
+   * Complete TLS handshake if it is not completed yet.
+   * Called implicitly on first &l:Connection::read (); or &l:Connection::write ();.
+   * @return - `0` on success, &id:oatpp::data::IOError::WAIT_RETRY; if non-blocking handshake is in progress,
+   * negative value on error.
+   */
+  data::v_io_size handshake();
+
+  /**
+   * Set verifier of peer certificate chain. Verification is done right after the handshake -
+   * if it fails the handshake fails.
+   * Set by &id:oatpp::libressl::server::ConnectionProvider; when client auth is enabled in &id:oatpp::libressl::Config;.
+   * @param verifier - &id:oatpp::libressl::ClientCertVerifier;.
+   */
+  void setCertVerifier(const std::shared_ptr<ClientCertVerifier>& verifier);
+
+  /**
+   * Set ticket keys of server `tls_config` shared with &id:oatpp::libressl::SessionStore;.
+   * Each `tls_handshake()` call holds their shared lock, so that keys are not changed while the handshake reads them.
+   * Set by &id:oatpp::libressl::server::ConnectionProvider; when the config has session store.
+   * @param keys - &id:oatpp::libressl::SessionStore::ConfigKeys;. May be `nullptr`.
+   */
+  void setSessionKeys(const std::shared_ptr<SessionStore::ConfigKeys>& keys);
+
+  /**
+   * Limit write rate of this connection. Limiters are applied on top of each other.
+   * When throttled, blocking connection sleeps, and non-blocking connection returns
+   * &id:oatpp::data::IOError::WAIT_RETRY; so that coroutine yields to other coroutines.
+   * Must be called before the connection is used.
+   * @param limiter - &id:oatpp::libressl::RateLimiter; of this connection only. May be `nullptr`.
+   * @param sharedLimiter - &id:oatpp::libressl::RateLimiter; shared with other connections. May be `nullptr`.
+   */
+  void setWriteLimiters(const std::shared_ptr<RateLimiter>& limiter, const std::shared_ptr<RateLimiter>& sharedLimiter);
+
+  /**
+   * Get total time writes on this connection were throttled by write limiters.
+   * @return - microseconds.
+   */
+  v_int64 getThrottledMicros() {
+    return m_throttledMicros.load();
+  }
+
+  /**
+   * Get parameters negotiated for this connection.
+   * Values are read from libtls once after the handshake and cached for the lifetime of the connection.
+   * Doesn't do I/O - call &l:Connection::handshake (); first to complete the handshake.
+   * @return - `std::shared_ptr` to &id:oatpp::libressl::TlsInfo;. `nullptr` if handshake is not completed yet.
+   */
+  std::shared_ptr<const TlsInfo> getTlsInfo();
+
+  /**
+   * Get application protocol negotiated via ALPN.
+   * Value is taken from cached &l:Connection::getTlsInfo ();.
+   * @return - protocol name. Ex.: "h2". `nullptr` if no protocol was negotiated or handshake is not completed yet.
+   */
+  oatpp::String getAlpnProtocol();
+
+  /**
+   * Get message of the last error occurred on this connection.
+   * Errors are not logged on each read/write - see &id:oatpp::libressl::ErrorStats;.
+   * @return - error message. `nullptr` if no error occurred.
+   */
+  oatpp::String getLastError();
+
+  /**
+   * Enable/disable full-duplex mode - one thread may read while another thread writes.
+   * libtls context is guarded by a lock which is held only for the duration of libtls calls.
+   * Socket is switched to non-blocking mode, and for blocking connection waiting for socket readiness
+   * is done outside of the lock, so reader and writer never block each other.<br>
+   * For connections over &id:oatpp::data::stream::IOStream; the stream should be non-blocking,
+   * otherwise the lock is held while the stream blocks. Such connection becomes blocking - there is no handle
+   * to poll, so while the stream returns &id:oatpp::data::IOError::WAIT_RETRY; calls retry with a growing back off.<br>
+   * Must be called before the connection is shared between threads.
+   * @param enabled - `true` to enable full-duplex mode.
+   */
+  void setFullDuplex(bool enabled);
+
+  /**
+   * Check if full-duplex mode is enabled.
+   * @return - `true` if enabled.
+   */
+  bool isFullDuplex() {
+    return m_fullDuplex;
+  }
+
+  /**
+   * Send TLS close_notify to the peer - signal end of data in the write direction.
+   * Reading is still possible until the peer closes its side.
+   * @return - `0` on success, &id:oatpp::data::IOError::WAIT_RETRY; if non-blocking operation is in progress,
+   * negative value on error.
+   */
+  data::v_io_size closeWrite();
+
+  /**
+   * Close all handles. close_notify is sent unless it was already sent by &l:Connection::closeWrite ();.
    */
   void close();
 
@@ -97,13 +340,31 @@ public:
     return m_tlsHandle;
   }
 
+  /**
+   * Get underlying transport stream.
+   * @return - &id:oatpp::data::stream::IOStream;. `nullptr` if TLS runs directly over socket handle.
+   */
+  std::shared_ptr<oatpp::data::stream::IOStream> getStream() {
+    return m_stream;
+  }
+
   /**
    * Get socket handle.
-   * @return - &id:oatpp::data::v_io_handle;.
+   * @return - &id:oatpp::data::v_io_handle;. `-1` if TLS runs over &id:oatpp::data::stream::IOStream;.
    */
   data::v_io_handle getHandle() {
     return m_handle;
   }
+
+#ifdef OATPP_LIBRESSL_TRACE
+  /**
+   * Get trace span of this connection. Available only when built with `-DOATPP_LIBRESSL_TRACE=ON`.
+   * @return - &id:oatpp::libressl::Trace::Span;.
+   */
+  Trace::Span& getTraceSpan() {
+    return m_traceSpan;
+  }
+#endif
   
 };
   
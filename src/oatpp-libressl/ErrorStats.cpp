@@ -0,0 +1,105 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ErrorStats.hpp"
+
+#include <errno.h>
+
+namespace oatpp { namespace libressl {
+
+ErrorStats::Counter ErrorStats::COUNTERS[TYPES_COUNT];
+std::atomic<v_int64> ErrorStats::LOG_INTERVAL_MICROS(1000 * 1000);
+
+namespace {
+
+bool isPeerResetErrno(int errorNumber) {
+  switch(errorNumber) {
+    case ECONNRESET:
+    case ECONNABORTED:
+    case EPIPE:
+    case ETIMEDOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}
+
+ErrorStats::Type ErrorStats::classify(int errorNumber, bool handshakeDone) {
+  if(errorNumber == 0) {
+    return handshakeDone ? PROTOCOL : HANDSHAKE;
+  }
+  if(isPeerResetErrno(errorNumber)) {
+    return PEER_RESET;
+  }
+  return OTHER;
+}
+
+void ErrorStats::onError(Type type, const char* tag, const char* message) {
+
+  Counter& counter = COUNTERS[type];
+  v_int64 count = counter.count.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  v_int64 interval = LOG_INTERVAL_MICROS.load(std::memory_order_relaxed);
+  if(interval < 0) {
+    return;
+  }
+
+  v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+  v_int64 lastTick = counter.lastLogTick.load(std::memory_order_relaxed);
+  if(lastTick != 0 && tick - lastTick < interval) {
+    return;
+  }
+
+  /* only one thread gets to log per interval */
+  if(!counter.lastLogTick.compare_exchange_strong(lastTick, tick, std::memory_order_relaxed)) {
+    return;
+  }
+
+  v_int64 suppressed = count - counter.lastLogCount.exchange(count, std::memory_order_relaxed) - 1;
+  OATPP_LOGD(tag, "%s error - %s (total=%lld, suppressed since last log=%lld)",
+             getTypeName(type), message != nullptr ? message : "unknown", (long long) count, (long long) suppressed);
+
+}
+
+v_int64 ErrorStats::getCount(Type type) {
+  return COUNTERS[type].count.load(std::memory_order_relaxed);
+}
+
+const char* ErrorStats::getTypeName(Type type) {
+  switch(type) {
+    case PEER_RESET: return "peer-reset";
+    case HANDSHAKE: return "handshake";
+    case PROTOCOL: return "protocol";
+    default: return "other";
+  }
+}
+
+void ErrorStats::setLogInterval(v_int64 micros) {
+  LOG_INTERVAL_MICROS.store(micros, std::memory_order_relaxed);
+}
+
+}}
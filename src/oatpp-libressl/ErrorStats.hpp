@@ -0,0 +1,132 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_ErrorStats_hpp
+#define oatpp_libressl_ErrorStats_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <atomic>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Process-wide counters of TLS connection errors.
+ * Errors are counted by type. Logging is rate-limited - at most one log line per error type
+ * is written per log interval, with the number of errors suppressed since the previous line.
+ * Counting and sampling are lock-free, so error bursts don't serialize I/O threads on the logger.
+ */
+class ErrorStats {
+public:
+
+  /**
+   * Error type.
+   */
+  enum Type : v_int32 {
+
+    /**
+     * Peer closed or reset the connection (ECONNRESET, EPIPE, ...).
+     */
+    PEER_RESET = 0,
+
+    /**
+     * Handshake failed on TLS level - no system error.
+     */
+    HANDSHAKE = 1,
+
+    /**
+     * TLS protocol error after handshake - no system error.
+     */
+    PROTOCOL = 2,
+
+    /**
+     * Any other system error (EBADF, ENOMEM, EIO, ...).
+     */
+    OTHER = 3,
+
+    /**
+     * Number of error types.
+     */
+    TYPES_COUNT = 4
+
+  };
+
+private:
+
+  struct Counter {
+    std::atomic<v_int64> count;
+    std::atomic<v_int64> lastLogCount;
+    std::atomic<v_int64> lastLogTick;
+  };
+
+private:
+  static Counter COUNTERS[TYPES_COUNT];
+  static std::atomic<v_int64> LOG_INTERVAL_MICROS;
+public:
+
+  /**
+   * Classify error by `errno` saved right after the failed libtls call.
+   * libtls sets `errno` only when the underlying I/O fails, so reset it to `0` before the call -
+   * then `0` means TLS level error.
+   * @param errorNumber - `errno`. `0` if not set by the failed call.
+   * @param handshakeDone - `true` if handshake was already completed.
+   * @return - &l:ErrorStats::Type;.
+   */
+  static Type classify(int errorNumber, bool handshakeDone);
+
+  /**
+   * Count error and log it if log interval for this error type has elapsed.
+   * @param type - &l:ErrorStats::Type;.
+   * @param tag - log tag.
+   * @param message - error message. May be `nullptr`.
+   */
+  static void onError(Type type, const char* tag, const char* message);
+
+  /**
+   * Get number of errors of given type counted since process start.
+   * @param type - &l:ErrorStats::Type;.
+   * @return - number of errors.
+   */
+  static v_int64 getCount(Type type);
+
+  /**
+   * Get name of the error type.
+   * @param type - &l:ErrorStats::Type;.
+   * @return - name of the error type.
+   */
+  static const char* getTypeName(Type type);
+
+  /**
+   * Set minimal interval between two log lines of the same error type.
+   * `0` - log every error. Negative value - don't log errors at all. Default is one second.
+   * @param micros - interval in microseconds.
+   */
+  static void setLogInterval(v_int64 micros);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_ErrorStats_hpp */
@@ -0,0 +1,237 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ListenerHandoff.hpp"
+
+#include "oatpp-libressl/UnixSocketAddress.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  const char MESSAGE_LISTENER = 'L';
+  const char MESSAGE_ACK = 'A';
+
+  bool waitFor(data::v_io_handle handle, short events, v_int64 deadline) {
+    while(true) {
+      v_int64 left = deadline - oatpp::base::Environment::getMicroTickCount();
+      if(left <= 0) {
+        return false;
+      }
+      struct pollfd pfd;
+      pfd.fd = handle;
+      pfd.events = events;
+      pfd.revents = 0;
+      int res = poll(&pfd, 1, (int) ((left + 999) / 1000));
+      if(res > 0) {
+        return true;
+      }
+      if(res < 0 && errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  bool isSameUser(data::v_io_handle handle) {
+#if defined(SO_PEERCRED)
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if(getsockopt(handle, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+      return false;
+    }
+    return credentials.uid == getuid() || credentials.uid == 0;
+#else
+    uid_t uid;
+    gid_t gid;
+    if(getpeereid(handle, &uid, &gid) != 0) {
+      return false;
+    }
+    return uid == getuid() || uid == 0;
+#endif
+  }
+
+}
+
+bool ListenerHandoff::send(const oatpp::String& handoffPath, data::v_io_handle listenerHandle, v_int64 timeoutMicros) {
+
+  struct sockaddr_un addr;
+  socklen_t addrLength = UnixSocketAddress::fill(handoffPath, &addr);
+  if(addrLength == 0) {
+    throw std::runtime_error("[oatpp::libressl::ListenerHandoff::send()]: Invalid handoff socket path");
+  }
+
+  data::v_io_handle serverHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(serverHandle < 0) {
+    throw std::runtime_error("[oatpp::libressl::ListenerHandoff::send()]: Can't create socket");
+  }
+
+  if(!UnixSocketAddress::removeStale(handoffPath)) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::ListenerHandoff::send()]: "
+                             "Handoff path exists and is not a stale socket - another handoff is in progress or it is not a socket");
+  }
+
+  if(bind(serverHandle, (struct sockaddr*) &addr, addrLength) != 0 || listen(serverHandle, 1) != 0) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::ListenerHandoff::send()]: Can't listen on handoff socket");
+  }
+
+  v_int64 deadline = oatpp::base::Environment::getMicroTickCount() + timeoutMicros;
+  bool result = false;
+
+  while(!result && waitFor(serverHandle, POLLIN, deadline)) {
+
+    data::v_io_handle handle = accept(serverHandle, nullptr, nullptr);
+    if(handle < 0) {
+      continue;
+    }
+
+    if(!isSameUser(handle)) {
+      OATPP_LOGD("[oatpp::libressl::ListenerHandoff::send()]", "Rejected handoff to process of other user");
+      ::close(handle);
+      continue;
+    }
+
+    char message = MESSAGE_LISTENER;
+    struct iovec iov;
+    iov.iov_base = &message;
+    iov.iov_len = 1;
+
+    union {
+      struct cmsghdr header;
+      char data[CMSG_SPACE(sizeof(int))];
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data;
+    msg.msg_controllen = sizeof(control.data);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &listenerHandle, sizeof(int));
+
+    /* successor confirms, so that the caller may close its copy of listener right after */
+    char ack = 0;
+    if(sendmsg(handle, &msg, 0) == 1 && waitFor(handle, POLLIN, deadline) && ::recv(handle, &ack, 1, 0) == 1) {
+      result = (ack == MESSAGE_ACK);
+    }
+
+    ::close(handle);
+
+  }
+
+  ::close(serverHandle);
+  if(!UnixSocketAddress::isAbstract(handoffPath)) {
+    ::unlink(handoffPath->c_str());
+  }
+
+  return result;
+
+}
+
+data::v_io_handle ListenerHandoff::receive(const oatpp::String& handoffPath, v_int64 timeoutMicros) {
+
+  struct sockaddr_un addr;
+  socklen_t addrLength = UnixSocketAddress::fill(handoffPath, &addr);
+  if(addrLength == 0) {
+    return -1;
+  }
+
+  data::v_io_handle handle = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(handle < 0) {
+    return -1;
+  }
+
+  if(connect(handle, (struct sockaddr*) &addr, addrLength) != 0) {
+    /* no predecessor */
+    ::close(handle);
+    return -1;
+  }
+
+  v_int64 deadline = oatpp::base::Environment::getMicroTickCount() + timeoutMicros;
+
+  if(!waitFor(handle, POLLIN, deadline)) {
+    ::close(handle);
+    return -1;
+  }
+
+  char message = 0;
+  struct iovec iov;
+  iov.iov_base = &message;
+  iov.iov_len = 1;
+
+  union {
+    struct cmsghdr header;
+    char data[CMSG_SPACE(sizeof(int))];
+  } control;
+  std::memset(&control, 0, sizeof(control));
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.data;
+  msg.msg_controllen = sizeof(control.data);
+
+  data::v_io_handle listenerHandle = -1;
+
+  if(recvmsg(handle, &msg, 0) == 1 && message == MESSAGE_LISTENER) {
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if(cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      std::memcpy(&listenerHandle, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+
+  if(listenerHandle >= 0) {
+    fcntl(listenerHandle, F_SETFD, FD_CLOEXEC);
+    char ack = MESSAGE_ACK;
+    if(::send(handle, &ack, 1, 0) != 1) {
+      /* predecessor won't close its listener - both keep accepting, which is harmless */
+      OATPP_LOGD("[oatpp::libressl::ListenerHandoff::receive()]", "Failed to confirm handoff");
+    }
+  }
+
+  ::close(handle);
+  return listenerHandle;
+
+}
+
+}}
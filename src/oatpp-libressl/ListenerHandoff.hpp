@@ -0,0 +1,69 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_ListenerHandoff_hpp
+#define oatpp_libressl_ListenerHandoff_hpp
+
+#include "oatpp/core/data/IODefinitions.hpp"
+#include "oatpp/core/Types.hpp"
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Pass listen socket from running process to its successor over unix domain socket (`SCM_RIGHTS`).
+ * Both processes share the same kernel socket, so connections queued in the backlog are accepted by one or the other -
+ * new connections never see a gap during restart.<br>
+ * Established TLS connections can't be moved - libtls state lives in process memory -
+ * so the old process serves them until they drain.<br>
+ * Only processes of the same user (or root) may take the socket.
+ * See &id:oatpp::libressl::server::ConnectionProvider::exportListener;.
+ */
+class ListenerHandoff {
+public:
+
+  /**
+   * Listen on `handoffPath` and pass `listenerHandle` to the first process which connects.
+   * Blocks until successor confirmed that it took the socket, or until timeout.
+   * @param handoffPath - unix socket path. Start path with '@' to use Linux abstract namespace.
+   * @param listenerHandle - listen socket.
+   * @param timeoutMicros - how long to wait for successor.
+   * @return - `true` if successor took the socket.
+   * @throws - `std::runtime_error` if `handoffPath` can't be listened on.
+   */
+  static bool send(const oatpp::String& handoffPath, data::v_io_handle listenerHandle, v_int64 timeoutMicros);
+
+  /**
+   * Take listen socket from predecessor process which is in &l:ListenerHandoff::send ();.
+   * @param handoffPath - unix socket path.
+   * @param timeoutMicros - how long to wait for the socket once connected to predecessor.
+   * @return - listen socket. `-1` if there is no predecessor at `handoffPath` or handoff failed.
+   */
+  static data::v_io_handle receive(const oatpp::String& handoffPath, v_int64 timeoutMicros);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_ListenerHandoff_hpp */
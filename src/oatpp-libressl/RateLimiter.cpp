@@ -0,0 +1,99 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "RateLimiter.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+namespace oatpp { namespace libressl {
+
+RateLimiter::RateLimiter(v_int64 bytesPerSecond, v_int64 burst)
+  : m_atom(false)
+  , m_bytesPerSecond(bytesPerSecond > 0 ? bytesPerSecond : 1)
+  , m_burst(burst > 0 ? burst : 1)
+  , m_tokens(m_burst)
+  , m_fillMicros(m_burst * 1000000 / m_bytesPerSecond + 1)
+  , m_lastRefill(oatpp::base::Environment::getMicroTickCount())
+  , m_throttledCount(0)
+  , m_throttledMicros(0)
+{}
+
+std::shared_ptr<RateLimiter> RateLimiter::createShared(v_int64 bytesPerSecond, v_int64 burst) {
+  return std::make_shared<RateLimiter>(bytesPerSecond, burst);
+}
+
+void RateLimiter::refill(v_int64 now) {
+  v_int64 elapsed = now - m_lastRefill;
+  if(elapsed >= m_fillMicros) {
+    m_tokens = m_burst;
+    m_lastRefill = now;
+    return;
+  }
+  v_int64 tokens = elapsed * m_bytesPerSecond / 1000000;
+  if(tokens > 0) {
+    m_tokens += tokens;
+    /* advance by the time the added tokens took - keep the remainder for the next refill */
+    m_lastRefill += tokens * 1000000 / m_bytesPerSecond;
+    if(m_tokens >= m_burst) {
+      m_tokens = m_burst;
+      m_lastRefill = now;
+    }
+  }
+}
+
+v_int64 RateLimiter::acquire(v_int64 count) {
+  v_int64 now = oatpp::base::Environment::getMicroTickCount();
+  oatpp::concurrency::SpinLock lock(m_atom);
+  refill(now);
+  v_int64 granted = count < m_tokens ? count : m_tokens;
+  m_tokens -= granted;
+  return granted;
+}
+
+void RateLimiter::refund(v_int64 count) {
+  oatpp::concurrency::SpinLock lock(m_atom);
+  m_tokens += count;
+  if(m_tokens > m_burst) {
+    m_tokens = m_burst;
+  }
+}
+
+v_int64 RateLimiter::getWaitMicros() {
+  v_int64 now = oatpp::base::Environment::getMicroTickCount();
+  oatpp::concurrency::SpinLock lock(m_atom);
+  refill(now);
+  if(m_tokens > 0) {
+    return 0;
+  }
+  v_int64 wait = m_lastRefill + 1000000 / m_bytesPerSecond - now;
+  return wait > 0 ? wait : 1;
+}
+
+void RateLimiter::onThrottled(v_int64 micros) {
+  m_throttledCount ++;
+  m_throttledMicros.fetch_add(micros);
+}
+
+}}
@@ -0,0 +1,133 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_RateLimiter_hpp
+#define oatpp_libressl_RateLimiter_hpp
+
+#include "oatpp/core/concurrency/SpinLock.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Token bucket limiting write rate in bytes per second.
+ * Bucket holds up to `burst` bytes and is refilled continuously at `bytesPerSecond`.
+ * One limiter may be shared by many connections - ex.: per-provider limit.
+ * See &id:oatpp::libressl::Connection::setWriteLimiters;.
+ */
+class RateLimiter {
+private:
+  oatpp::concurrency::SpinLock::Atom m_atom;
+  v_int64 m_bytesPerSecond;
+  v_int64 m_burst;
+  v_int64 m_tokens;
+  v_int64 m_fillMicros;
+  v_int64 m_lastRefill;
+  std::atomic<v_int64> m_throttledCount;
+  std::atomic<v_int64> m_throttledMicros;
+private:
+  void refill(v_int64 now);
+public:
+
+  /**
+   * Constructor.
+   * @param bytesPerSecond - rate.
+   * @param burst - bucket size in bytes. Max amount of bytes written at once.
+   */
+  RateLimiter(v_int64 bytesPerSecond, v_int64 burst);
+
+  /**
+   * Create shared RateLimiter.
+   * @param bytesPerSecond - rate.
+   * @param burst - bucket size in bytes.
+   * @return - `std::shared_ptr` to RateLimiter.
+   */
+  static std::shared_ptr<RateLimiter> createShared(v_int64 bytesPerSecond, v_int64 burst);
+
+  /**
+   * Take up to `count` tokens.
+   * @param count - wanted amount of bytes.
+   * @return - granted amount of bytes. `0` if bucket is empty.
+   */
+  v_int64 acquire(v_int64 count);
+
+  /**
+   * Return tokens which were acquired but not used (ex.: partial write).
+   * @param count - amount of bytes.
+   */
+  void refund(v_int64 count);
+
+  /**
+   * Get time until at least one token is available.
+   * @return - microseconds.
+   */
+  v_int64 getWaitMicros();
+
+  /**
+   * Account time during which writer was throttled by this limiter.
+   * @param micros - throttled time in microseconds.
+   */
+  void onThrottled(v_int64 micros);
+
+  /**
+   * Get number of times writers were throttled.
+   * @return - count.
+   */
+  v_int64 getThrottledCount() {
+    return m_throttledCount.load();
+  }
+
+  /**
+   * Get total time writers were throttled.
+   * @return - microseconds.
+   */
+  v_int64 getThrottledMicros() {
+    return m_throttledMicros.load();
+  }
+
+  /**
+   * Get rate.
+   * @return - bytes per second.
+   */
+  v_int64 getBytesPerSecond() {
+    return m_bytesPerSecond;
+  }
+
+  /**
+   * Get bucket size.
+   * @return - bytes.
+   */
+  v_int64 getBurst() {
+    return m_burst;
+  }
+
+};
+
+}}
+
+#endif /* oatpp_libressl_RateLimiter_hpp */
@@ -0,0 +1,275 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Relay.hpp"
+
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  /*
+   * Blocking relay has nothing to poll - streams are generic IOStreams.
+   * When neither side made progress wait a little, longer with each idle step.
+   */
+  void backOff(v_int32& idleSteps) {
+    if(idleSteps < 16) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(idleSteps < 64 ? 100 : 1000));
+    }
+    idleSteps ++;
+  }
+
+}
+
+Relay::Stats::Stats()
+  : bytesToBackend(0)
+  , bytesToPeer(0)
+  , chunks(0)
+  , forwardMicros(0)
+  , maxForwardMicros(0)
+  , relaysFinished(0)
+{}
+
+Relay::Direction::Direction(oatpp::data::stream::IOStream* from,
+                            oatpp::data::stream::IOStream* to,
+                            v_int32 bufferSize,
+                            std::atomic<v_int64>* bytesCounter,
+                            Stats* stats)
+  : m_from(from)
+  , m_to(to)
+  , m_buffer(bufferSize)
+  , m_size(0)
+  , m_position(0)
+  , m_readTick(0)
+  , m_eof(false)
+  , m_done(false)
+  , m_bytesCounter(bytesCounter)
+  , m_stats(stats)
+{}
+
+v_int32 Relay::Direction::pump(const std::function<data::v_io_size()>& onEof) {
+
+  if(m_done) {
+    return 0;
+  }
+
+  if(m_position < m_size) {
+    auto result = m_to->write(&m_buffer[m_position], m_size - m_position);
+    if(result > 0) {
+      m_position += result;
+      if(m_position == m_size && m_stats != nullptr) {
+        v_int64 micros = oatpp::base::Environment::getMicroTickCount() - m_readTick;
+        m_bytesCounter->fetch_add(m_size);
+        m_stats->chunks ++;
+        m_stats->forwardMicros.fetch_add(micros);
+        v_int64 max = m_stats->maxForwardMicros.load();
+        while(micros > max && !m_stats->maxForwardMicros.compare_exchange_weak(max, micros)) {}
+      }
+      return 1;
+    }
+    if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+      return 0;
+    }
+    return -1;
+  }
+
+  if(m_eof) {
+    auto result = onEof ? onEof() : 0;
+    if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+      return 0;
+    }
+    // Failure to close write direction is not an error of relay - data is already delivered.
+    m_done = true;
+    return 1;
+  }
+
+  auto result = m_from->read(m_buffer.data(), m_buffer.size());
+  if(result > 0) {
+    m_size = result;
+    m_position = 0;
+    if(m_stats != nullptr) {
+      m_readTick = oatpp::base::Environment::getMicroTickCount();
+    }
+    return 1;
+  }
+  if(result == 0) {
+    m_eof = true;
+    return 1;
+  }
+  if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+    return 0;
+  }
+  return -1;
+
+}
+
+Relay::RelayCoroutine::RelayCoroutine(const std::shared_ptr<Connection>& connection,
+                                      const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                                      const std::shared_ptr<Stats>& stats,
+                                      const CloseWriteCallback& backendCloseWrite,
+                                      v_int32 bufferSize,
+                                      const ShutdownCallback& backendShutdown)
+  : m_connection(connection)
+  , m_backend(backend)
+  , m_stats(stats)
+  , m_backendCloseWrite(backendCloseWrite)
+  , m_backendShutdown(backendShutdown)
+  , m_toBackend(connection.get(), backend.get(), bufferSize,
+                stats ? &stats->bytesToBackend : nullptr, stats.get())
+  , m_toPeer(backend.get(), connection.get(), bufferSize,
+             stats ? &stats->bytesToPeer : nullptr, stats.get())
+{}
+
+oatpp::async::Action Relay::RelayCoroutine::act() {
+
+  auto toBackend = m_toBackend.pump([this]() -> data::v_io_size {
+    if(m_backendCloseWrite) {
+      m_backendCloseWrite();
+    } else if(m_backendShutdown) {
+      m_backendShutdown();
+    }
+    return 0;
+  });
+
+  auto toPeer = m_toPeer.pump([this]() -> data::v_io_size {
+    return m_connection->closeWrite();
+  });
+
+  if(toBackend < 0 || toPeer < 0) {
+    Relay::shutdown(m_connection, m_backendShutdown);
+    return error<Error>("[oatpp::libressl::Relay::RelayCoroutine::act()]: Error. I/O error while relaying.");
+  }
+
+  if(m_toBackend.isDone() && m_toPeer.isDone()) {
+    if(m_stats) {
+      m_stats->relaysFinished ++;
+    }
+    return finish();
+  }
+
+  if(toBackend > 0 || toPeer > 0) {
+    return repeat();
+  }
+
+  return waitRetry();
+
+}
+
+oatpp::async::CoroutineStarter Relay::relayAsync(const std::shared_ptr<Connection>& connection,
+                                                 const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                                                 const std::shared_ptr<Stats>& stats,
+                                                 const CloseWriteCallback& backendCloseWrite,
+                                                 v_int32 bufferSize,
+                                                 const ShutdownCallback& backendShutdown)
+{
+  return RelayCoroutine::start(connection, backend, stats, backendCloseWrite, bufferSize, backendShutdown);
+}
+
+void Relay::shutdown(const std::shared_ptr<Connection>& connection, const ShutdownCallback& backendShutdown) {
+  /* wakes up poll() of the full-duplex connection - blocked read returns */
+  if(connection->getHandle() >= 0) {
+    ::shutdown(connection->getHandle(), SHUT_RDWR);
+  }
+  if(backendShutdown) {
+    backendShutdown();
+  }
+}
+
+void Relay::relay(const std::shared_ptr<Connection>& connection,
+                  const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                  const std::shared_ptr<Stats>& stats,
+                  const CloseWriteCallback& backendCloseWrite,
+                  v_int32 bufferSize,
+                  const ShutdownCallback& backendShutdown)
+{
+
+  connection->setFullDuplex(true);
+
+  Direction toBackend(connection.get(), backend.get(), bufferSize,
+                      stats ? &stats->bytesToBackend : nullptr, stats.get());
+  Direction toPeer(backend.get(), connection.get(), bufferSize,
+                   stats ? &stats->bytesToPeer : nullptr, stats.get());
+
+  /* the first failed direction shuts down both sides, so that the other one doesn't stay blocked in read */
+  std::atomic<bool> aborted(false);
+  auto abort = [&aborted, &connection, &backendShutdown]{
+    if(!aborted.exchange(true)) {
+      shutdown(connection, backendShutdown);
+    }
+  };
+
+  std::thread peerThread([&toPeer, &connection, &abort]{
+    v_int32 idleSteps = 0;
+    while(!toPeer.isDone()) {
+      auto result = toPeer.pump([&connection]{ return connection->closeWrite(); });
+      if(result < 0) {
+        abort();
+        break;
+      }
+      if(result == 0) {
+        backOff(idleSteps);
+      } else {
+        idleSteps = 0;
+      }
+    }
+  });
+
+  std::function<data::v_io_size()> onEof = [&backendCloseWrite, &backendShutdown]() -> data::v_io_size {
+    if(backendCloseWrite) {
+      backendCloseWrite();
+    } else if(backendShutdown) {
+      backendShutdown();
+    }
+    return 0;
+  };
+
+  v_int32 idleSteps = 0;
+  while(!toBackend.isDone()) {
+    auto result = toBackend.pump(onEof);
+    if(result < 0) {
+      abort();
+      break;
+    }
+    if(result == 0) {
+      backOff(idleSteps);
+    } else {
+      idleSteps = 0;
+    }
+  }
+
+  peerThread.join();
+
+  if(stats && toBackend.isDone() && toPeer.isDone()) {
+    stats->relaysFinished ++;
+  }
+
+}
+
+}}
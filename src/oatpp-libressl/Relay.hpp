@@ -0,0 +1,219 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_Relay_hpp
+#define oatpp_libressl_Relay_hpp
+
+#include "oatpp-libressl/Connection.hpp"
+
+#include "oatpp/core/async/Coroutine.hpp"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Bidirectional relay between TLS &id:oatpp::libressl::Connection; and plain &id:oatpp::data::stream::IOStream;.
+ * Used to terminate TLS in front of plaintext backends.<br>
+ * Each direction uses one fixed buffer allocated once per relay - no per-chunk allocations.<br>
+ * Half-close is propagated: when the backend finishes sending, close_notify is sent to the TLS peer
+ * (see &id:oatpp::libressl::Connection::closeWrite;), and when the TLS peer finishes sending, `backendCloseWrite`
+ * callback is called (ex.: `shutdown(fd, SHUT_WR)` on backend socket). The other direction keeps relaying
+ * until it finishes too.<br>
+ * When either direction fails, both sides are shut down - TLS socket with `shutdown(SHUT_RDWR)`,
+ * backend with `backendShutdown` callback - so that the other direction doesn't stay blocked in read.
+ */
+class Relay {
+public:
+
+  /**
+   * Default size of the buffer per direction. Max size of TLS record payload.
+   */
+  static constexpr v_int32 DEFAULT_BUFFER_SIZE = 16 * 1024;
+
+  /**
+   * Relay counters. May be shared by many relays.
+   */
+  struct Stats {
+
+    /**
+     * Bytes relayed from TLS peer to backend.
+     */
+    std::atomic<v_int64> bytesToBackend;
+
+    /**
+     * Bytes relayed from backend to TLS peer.
+     */
+    std::atomic<v_int64> bytesToPeer;
+
+    /**
+     * Number of chunks relayed in both directions.
+     */
+    std::atomic<v_int64> chunks;
+
+    /**
+     * Sum of times in microseconds between chunk was read and fully written to the other side.
+     */
+    std::atomic<v_int64> forwardMicros;
+
+    /**
+     * Max time in microseconds between chunk was read and fully written to the other side.
+     */
+    std::atomic<v_int64> maxForwardMicros;
+
+    /**
+     * Number of relays finished.
+     */
+    std::atomic<v_int64> relaysFinished;
+
+    Stats();
+
+  };
+
+  /**
+   * Callback closing write direction of the backend stream.
+   */
+  typedef std::function<void()> CloseWriteCallback;
+
+  /**
+   * Callback shutting down the backend stream in both directions (ex.: `shutdown(fd, SHUT_RDWR)` on backend socket).
+   * Must unblock reads and writes on the backend in progress in other threads.
+   */
+  typedef std::function<void()> ShutdownCallback;
+
+private:
+
+  class Direction {
+  private:
+    oatpp::data::stream::IOStream* m_from;
+    oatpp::data::stream::IOStream* m_to;
+    std::vector<v_char8> m_buffer;
+    data::v_io_size m_size;
+    data::v_io_size m_position;
+    v_int64 m_readTick;
+    bool m_eof;
+    bool m_done;
+    std::atomic<v_int64>* m_bytesCounter;
+    Stats* m_stats;
+  public:
+
+    Direction(oatpp::data::stream::IOStream* from,
+              oatpp::data::stream::IOStream* to,
+              v_int32 bufferSize,
+              std::atomic<v_int64>* bytesCounter,
+              Stats* stats);
+
+    /*
+     * Make one step of relaying.
+     * onEof - called when source reached EOF. Returns result of closing write direction of the destination.
+     * @return - `1` if made progress, `0` if has to wait for I/O, `-1` on error.
+     */
+    v_int32 pump(const std::function<data::v_io_size()>& onEof);
+
+    bool isDone() {
+      return m_done;
+    }
+
+  };
+
+private:
+  static void shutdown(const std::shared_ptr<Connection>& connection, const ShutdownCallback& backendShutdown);
+
+public:
+
+  /**
+   * Coroutine relaying both directions on non-blocking streams.
+   * Run it with `executor->execute<oatpp::libressl::Relay::RelayCoroutine>(...)` or use &l:Relay::relayAsync ();.
+   */
+  class RelayCoroutine : public oatpp::async::Coroutine<RelayCoroutine> {
+  private:
+    std::shared_ptr<Connection> m_connection;
+    std::shared_ptr<oatpp::data::stream::IOStream> m_backend;
+    std::shared_ptr<Stats> m_stats;
+    CloseWriteCallback m_backendCloseWrite;
+    ShutdownCallback m_backendShutdown;
+    Direction m_toBackend;
+    Direction m_toPeer;
+  public:
+
+    RelayCoroutine(const std::shared_ptr<Connection>& connection,
+                   const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                   const std::shared_ptr<Stats>& stats,
+                   const CloseWriteCallback& backendCloseWrite,
+                   v_int32 bufferSize,
+                   const ShutdownCallback& backendShutdown = nullptr);
+
+    Action act() override;
+
+  };
+
+public:
+
+  /**
+   * Relay in asynchronous manner. Both streams must be non-blocking.
+   * @param connection - TLS &id:oatpp::libressl::Connection;.
+   * @param backend - plain &id:oatpp::data::stream::IOStream;.
+   * @param stats - &l:Relay::Stats;. May be `nullptr`.
+   * @param backendCloseWrite - callback closing write direction of the backend. May be `nullptr` -
+   * then TLS peer EOF shuts the backend down with `backendShutdown`.
+   * @param bufferSize - size of the buffer per direction.
+   * @param backendShutdown - callback shutting down the backend on error. May be `nullptr`.
+   * @return - &id:oatpp::async::CoroutineStarter;.
+   */
+  static oatpp::async::CoroutineStarter relayAsync(const std::shared_ptr<Connection>& connection,
+                                                   const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                                                   const std::shared_ptr<Stats>& stats = nullptr,
+                                                   const CloseWriteCallback& backendCloseWrite = nullptr,
+                                                   v_int32 bufferSize = DEFAULT_BUFFER_SIZE,
+                                                   const ShutdownCallback& backendShutdown = nullptr);
+
+  /**
+   * Relay in blocking manner. Returns when both directions are finished.
+   * Backend-to-peer direction runs in a separate thread. Connection is switched to full-duplex mode -
+   * see &id:oatpp::libressl::Connection::setFullDuplex;. Backend may be non-blocking - while it has nothing
+   * to relay the thread backs off instead of spinning.
+   * @param connection - TLS &id:oatpp::libressl::Connection;.
+   * @param backend - plain &id:oatpp::data::stream::IOStream;. Must allow concurrent read and write.
+   * @param stats - &l:Relay::Stats;. May be `nullptr`.
+   * @param backendCloseWrite - callback closing write direction of the backend. May be `nullptr` -
+   * then TLS peer EOF shuts the backend down with `backendShutdown`.
+   * @param bufferSize - size of the buffer per direction.
+   * @param backendShutdown - callback shutting down the backend on error. Without it a failure of TLS side
+   * can't unblock backend-to-peer thread blocked in backend read. May be `nullptr`.
+   */
+  static void relay(const std::shared_ptr<Connection>& connection,
+                    const std::shared_ptr<oatpp::data::stream::IOStream>& backend,
+                    const std::shared_ptr<Stats>& stats = nullptr,
+                    const CloseWriteCallback& backendCloseWrite = nullptr,
+                    v_int32 bufferSize = DEFAULT_BUFFER_SIZE,
+                    const ShutdownCallback& backendShutdown = nullptr);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_Relay_hpp */
@@ -0,0 +1,273 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "SessionStore.hpp"
+
+#include <openssl/rand.h>
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  const v_word32 STATE_EMPTY = 0;
+  const v_word32 STATE_INITIALIZING = 1;
+  const v_word32 STATE_READY = 2;
+
+  /* Rotation lock held longer than that belongs to a dead worker and may be taken over */
+  const v_int64 LOCK_TIMEOUT = 10;
+
+  const v_int32 READ_ATTEMPTS = 100;
+
+}
+
+SessionStore::SessionStore(const oatpp::String& name, v_int32 lifetime)
+  : m_shared(nullptr)
+  , m_name(name)
+{
+
+  void* memory;
+
+  if(name) {
+
+    int fd = shm_open(name->c_str(), O_CREAT | O_RDWR, 0600);
+    if(fd < 0) {
+      throw std::runtime_error("[oatpp::libressl::SessionStore::SessionStore()]: Error. Call to shm_open() failed.");
+    }
+    if(ftruncate(fd, sizeof(Shared)) < 0) {
+      ::close(fd);
+      throw std::runtime_error("[oatpp::libressl::SessionStore::SessionStore()]: Error. Call to ftruncate() failed.");
+    }
+    memory = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+  } else {
+    memory = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  }
+
+  if(memory == MAP_FAILED) {
+    throw std::runtime_error("[oatpp::libressl::SessionStore::SessionStore()]: Error. Call to mmap() failed.");
+  }
+
+  /* memory is zero-filled - all atomics start with 0 */
+  m_shared = static_cast<Shared*>(memory);
+
+  v_word32 state = STATE_EMPTY;
+  if(m_shared->state.compare_exchange_strong(state, STATE_INITIALIZING)) {
+    try {
+      initialize(lifetime);
+    } catch (...) {
+      /* let the next opener initialize it instead of waiting for the creator which failed */
+      m_shared->state.store(STATE_EMPTY);
+      munmap(m_shared, sizeof(Shared));
+      throw;
+    }
+    m_shared->state.store(STATE_READY);
+    return;
+  }
+
+  for(v_int32 i = 0; i < 1000 && m_shared->state.load() != STATE_READY; i ++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  if(m_shared->state.load() != STATE_READY) {
+    munmap(m_shared, sizeof(Shared));
+    throw std::runtime_error("[oatpp::libressl::SessionStore::SessionStore()]: Error. Shared memory is not initialized by its creator.");
+  }
+
+}
+
+SessionStore::~SessionStore() {
+  munmap(m_shared, sizeof(Shared));
+}
+
+std::shared_ptr<SessionStore> SessionStore::createShared(const oatpp::String& name, v_int32 lifetime) {
+  return std::make_shared<SessionStore>(name, lifetime);
+}
+
+void SessionStore::unlink(const oatpp::String& name) {
+  shm_unlink(name->c_str());
+}
+
+void SessionStore::initialize(v_int32 lifetime) {
+  m_shared->lifetime = lifetime;
+  m_shared->nextKeyRev = 1;
+  if(RAND_bytes(m_shared->sessionId, sizeof(m_shared->sessionId)) != 1) {
+    throw std::runtime_error("[oatpp::libressl::SessionStore::initialize()]: Error. Call to RAND_bytes() failed.");
+  }
+  rotate((v_int64) std::time(nullptr));
+}
+
+bool SessionStore::readKeys(Key* keys, v_word64& sequence) {
+  for(v_int32 i = 0; i < READ_ATTEMPTS; i ++) {
+    v_word64 before = m_shared->sequence.load(std::memory_order_acquire);
+    if(before & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::memcpy(keys, m_shared->keys, sizeof(m_shared->keys));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(m_shared->sequence.load(std::memory_order_relaxed) == before) {
+      sequence = before;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SessionStore::rotate(v_int64 now) {
+
+  v_int64 lock = m_shared->lock.load();
+  if(lock != 0 && now - lock < LOCK_TIMEOUT) {
+    return;
+  }
+  if(!m_shared->lock.compare_exchange_strong(lock, now)) {
+    return;
+  }
+
+  if(m_shared->rotateAt.load() > now) {
+    /* rotated by other worker */
+    m_shared->lock.store(0);
+    return;
+  }
+
+  Key key;
+  key.keyRev = m_shared->nextKeyRev ++;
+  key.createdAt = now;
+  if(RAND_bytes(key.key, sizeof(key.key)) != 1) {
+    m_shared->lock.store(0);
+    return;
+  }
+
+  /* odd sequence - write in progress. Sequence is left odd if the previous writer died mid-write */
+  v_word64 sequence = m_shared->sequence.load();
+  if((sequence & 1) == 0) {
+    sequence ++;
+    m_shared->sequence.store(sequence);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  /* newest key first */
+  std::memmove(&m_shared->keys[1], &m_shared->keys[0], sizeof(Key) * (KEYS_COUNT - 1));
+  m_shared->keys[0] = key;
+
+  m_shared->sequence.store(sequence + 1, std::memory_order_release);
+  m_shared->rotateAt.store(now + m_shared->lifetime / 2);
+  m_shared->lock.store(0);
+
+}
+
+SessionStore::ConfigKeys::ConfigKeys(struct tls_config* config)
+  : m_config(config)
+  , m_syncedSequence(0)
+{
+  pthread_rwlock_init(&m_lock, nullptr);
+}
+
+SessionStore::ConfigKeys::~ConfigKeys() {
+  pthread_rwlock_destroy(&m_lock);
+}
+
+void SessionStore::ConfigKeys::lockShared() {
+  pthread_rwlock_rdlock(&m_lock);
+}
+
+void SessionStore::ConfigKeys::unlockShared() {
+  pthread_rwlock_unlock(&m_lock);
+}
+
+std::shared_ptr<SessionStore::ConfigKeys> SessionStore::configure(struct tls_config* config) {
+
+  if(tls_config_set_session_id(config, m_shared->sessionId, sizeof(m_shared->sessionId)) < 0) {
+    throw std::runtime_error("[oatpp::libressl::SessionStore::configure()]: failed call to tls_config_set_session_id()");
+  }
+
+  if(tls_config_set_session_lifetime(config, m_shared->lifetime) < 0) {
+    throw std::runtime_error("[oatpp::libressl::SessionStore::configure()]: failed call to tls_config_set_session_lifetime()");
+  }
+
+  auto keys = std::make_shared<ConfigKeys>(config);
+
+  /* adding keys also disables libtls own key rotation, which is per-process */
+  sync(*keys);
+
+  return keys;
+
+}
+
+void SessionStore::sync(ConfigKeys& keys) {
+
+  v_int64 now = (v_int64) std::time(nullptr);
+  if(now >= m_shared->rotateAt.load()) {
+    rotate(now);
+  }
+
+  if(m_shared->sequence.load(std::memory_order_acquire) == keys.m_syncedSequence.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  /* busy - handshakes in progress or other thread syncs */
+  if(pthread_rwlock_trywrlock(&keys.m_lock) != 0) {
+    return;
+  }
+
+  Key storeKeys[KEYS_COUNT];
+  v_word64 sequence;
+  if(readKeys(storeKeys, sequence) && sequence != keys.m_syncedSequence.load(std::memory_order_relaxed)) {
+    /* libtls encrypts tickets with the last added key - add oldest first. Already added keys are skipped by libtls */
+    for(v_int32 i = KEYS_COUNT - 1; i >= 0; i --) {
+      if(storeKeys[i].keyRev != 0) {
+        tls_config_add_ticket_key(keys.m_config, storeKeys[i].keyRev, storeKeys[i].key, sizeof(storeKeys[i].key));
+      }
+    }
+    keys.m_syncedSequence.store(sequence, std::memory_order_relaxed);
+  }
+
+  pthread_rwlock_unlock(&keys.m_lock);
+
+}
+
+v_int32 SessionStore::getLifetime() {
+  return m_shared->lifetime;
+}
+
+v_word32 SessionStore::getKeyRevision() {
+  Key keys[KEYS_COUNT];
+  v_word64 sequence;
+  if(!readKeys(keys, sequence)) {
+    return 0;
+  }
+  return keys[0].keyRev;
+}
+
+}}
@@ -0,0 +1,189 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_SessionStore_hpp
+#define oatpp_libressl_SessionStore_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <tls.h>
+
+#include <atomic>
+#include <memory>
+#include <pthread.h>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Session resumption state shared by server processes on one host (`SO_REUSEPORT` workers, forked workers).<br>
+ * libtls resumes sessions with tickets only and doesn't expose its session cache, so instead of sharing sessions
+ * the store shares what a ticket needs to be accepted by any worker: session id context and ticket encryption keys.
+ * Keys live in shared memory and are rotated every `lifetime / 2` seconds by whichever worker notices first.
+ * Each worker picks up new keys on accept - see &id:oatpp::libressl::Config::setSessionStore;.<br>
+ * Reading keys is lock-free (seqlock). Rotation is guarded by a try-lock - workers never wait for each other.<br>
+ * Within a process, handshakes read ticket keys from `tls_config` while new keys are added to it - so keys are added
+ * under exclusive &l:SessionStore::ConfigKeys; lock, and server handshakes hold it shared.
+ */
+class SessionStore {
+public:
+
+  /**
+   * Number of ticket keys kept. Ticket is accepted while the key it was encrypted with is kept.
+   */
+  static constexpr v_int32 KEYS_COUNT = 3;
+
+  /**
+   * Default session lifetime in seconds.
+   */
+  static constexpr v_int32 DEFAULT_LIFETIME = 2 * 60 * 60;
+
+private:
+
+  struct Key {
+    v_word32 keyRev;
+    v_int64 createdAt;
+    unsigned char key[TLS_TICKET_KEY_SIZE];
+  };
+
+  struct Shared {
+    std::atomic<v_word32> state;
+    std::atomic<v_int64> lock;
+    std::atomic<v_word64> sequence;
+    std::atomic<v_int64> rotateAt;
+    v_word32 nextKeyRev;
+    v_int32 lifetime;
+    unsigned char sessionId[TLS_MAX_SESSION_ID_LENGTH];
+    Key keys[KEYS_COUNT];
+  };
+
+public:
+
+  /**
+   * Ticket keys of one `tls_config` synced from the store.
+   * Created by &l:SessionStore::configure ();.
+   */
+  class ConfigKeys {
+    friend SessionStore;
+  private:
+    struct tls_config* m_config;
+    std::atomic<v_word64> m_syncedSequence;
+    pthread_rwlock_t m_lock;
+  public:
+
+    /**
+     * Constructor.
+     * @param config - `tls_config*`.
+     */
+    ConfigKeys(struct tls_config* config);
+
+    /**
+     * Non-virtual destructor.
+     */
+    ~ConfigKeys();
+
+    /**
+     * Take shared lock - keys of `tls_config` are not changed until &l:SessionStore::ConfigKeys::unlockShared ();.
+     * Held by server connection for each `tls_handshake()` call.
+     */
+    void lockShared();
+
+    /**
+     * Release shared lock.
+     */
+    void unlockShared();
+
+  };
+
+private:
+  Shared* m_shared;
+  oatpp::String m_name;
+private:
+  void initialize(v_int32 lifetime);
+  bool readKeys(Key* keys, v_word64& sequence);
+  void rotate(v_int64 now);
+public:
+
+  /**
+   * Constructor.
+   * @param name - name of POSIX shared memory object (ex.: "/myserver-sessions"). All workers opening the same name share the store.
+   * `nullptr` - anonymous shared memory, shared with processes forked after the store is created.
+   * @param lifetime - session lifetime in seconds. Used only by the process which creates the store.
+   * @throws - `std::runtime_error` if shared memory can't be created.
+   */
+  SessionStore(const oatpp::String& name, v_int32 lifetime);
+
+  /**
+   * Virtual destructor. Unmaps shared memory. Shared memory object is not unlinked - see &l:SessionStore::unlink ();.
+   */
+  virtual ~SessionStore();
+
+  /**
+   * Create shared SessionStore.
+   * @param name - name of POSIX shared memory object. `nullptr` - anonymous shared memory.
+   * @param lifetime - session lifetime in seconds.
+   * @return - `std::shared_ptr` to SessionStore.
+   */
+  static std::shared_ptr<SessionStore> createShared(const oatpp::String& name = nullptr, v_int32 lifetime = DEFAULT_LIFETIME);
+
+  /**
+   * Remove named shared memory object. Workers which have it open keep using it.
+   * @param name - name of POSIX shared memory object.
+   */
+  static void unlink(const oatpp::String& name);
+
+  /**
+   * Set session id context, session lifetime and current ticket keys to `tls_config`.
+   * Must be called before `tls_configure()`.
+   * @param config - `tls_config*`.
+   * @return - &l:SessionStore::ConfigKeys; of this `tls_config` to pass to &l:SessionStore::sync ();.
+   * @throws - `std::runtime_error` on libtls error.
+   */
+  std::shared_ptr<ConfigKeys> configure(struct tls_config* config);
+
+  /**
+   * Rotate keys if it's time to, and add keys created by other workers to `tls_config`.
+   * Cheap when nothing changed - two atomic loads. Never waits - if handshakes hold the keys lock,
+   * keys are added on one of the next calls.
+   * @param keys - &l:SessionStore::ConfigKeys; returned by &l:SessionStore::configure ();.
+   */
+  void sync(ConfigKeys& keys);
+
+  /**
+   * Get session lifetime in seconds.
+   * @return - lifetime.
+   */
+  v_int32 getLifetime();
+
+  /**
+   * Get revision of the newest ticket key. Changes on each rotation.
+   * @return - key revision. `0` if keys are being rotated right now.
+   */
+  v_word32 getKeyRevision();
+
+};
+
+}}
+
+#endif /* oatpp_libressl_SessionStore_hpp */
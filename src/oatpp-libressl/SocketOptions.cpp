@@ -0,0 +1,222 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "SocketOptions.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  const v_int32 WARNED_OPTIONS_SIZE = 32;
+
+  std::atomic<const char*> WARNED_OPTIONS[WARNED_OPTIONS_SIZE];
+
+  /*
+   * Option which fails once usually fails on every socket (ex.: not supported by the kernel) - warn only once per option.
+   * Option names are string literals and are compared by pointer.
+   */
+  bool isFirstWarning(const char* name) {
+    for(v_int32 i = 0; i < WARNED_OPTIONS_SIZE; i ++) {
+      const char* warned = WARNED_OPTIONS[i].load(std::memory_order_relaxed);
+      if(warned == nullptr && WARNED_OPTIONS[i].compare_exchange_strong(warned, name)) {
+        return true;
+      }
+      if(warned == name) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+}
+
+SocketOptions::SocketOptions()
+  : reuseAddress(true)
+  , reusePort(false)
+  , backlog(10000)
+  , noDelay(false)
+  , keepAlive(false)
+  , keepAliveIdle(-1)
+  , keepAliveInterval(-1)
+  , keepAliveCount(-1)
+  , sendBufferSize(-1)
+  , receiveBufferSize(-1)
+  , fastOpen(false)
+  , fastOpenQueue(256)
+  , notSentLowat(-1)
+  , busyPoll(-1)
+{}
+
+std::shared_ptr<SocketOptions> SocketOptions::createShared() {
+  return std::make_shared<SocketOptions>();
+}
+
+std::shared_ptr<SocketOptions> SocketOptions::createLowLatencyProfile() {
+  auto options = createShared();
+  options->noDelay = true;
+  options->notSentLowat = 16 * 1024;
+  options->fastOpen = true;
+  return options;
+}
+
+std::shared_ptr<SocketOptions> SocketOptions::createThroughputProfile() {
+  auto options = createShared();
+  options->sendBufferSize = 4 * 1024 * 1024;
+  options->receiveBufferSize = 4 * 1024 * 1024;
+  options->keepAlive = true;
+  return options;
+}
+
+void SocketOptions::set(v_int32 handle, v_int32 level, v_int32 option, v_int32 value, const char* name) {
+  int optionValue = value;
+  if(setsockopt(handle, level, option, &optionValue, sizeof(int)) < 0 && isFirstWarning(name)) {
+    OATPP_LOGD("[oatpp::libressl::SocketOptions::set()]", "Warning failed to set %s for socket: %s. Further failures are not logged",
+               name, std::strerror(errno));
+  }
+}
+
+void SocketOptions::applyToListener(data::v_io_handle handle, bool tcp) const {
+
+  if(reuseAddress) {
+    set(handle, SOL_SOCKET, SO_REUSEADDR, 1, "SO_REUSEADDR");
+  }
+
+  if(reusePort) {
+#ifdef SO_REUSEPORT
+    set(handle, SOL_SOCKET, SO_REUSEPORT, 1, "SO_REUSEPORT");
+#else
+    if(isFirstWarning("SO_REUSEPORT")) {
+      OATPP_LOGD("[oatpp::libressl::SocketOptions::applyToListener()]", "Warning %s is not supported", "SO_REUSEPORT");
+    }
+#endif
+  }
+
+  if(receiveBufferSize >= 0) {
+    set(handle, SOL_SOCKET, SO_RCVBUF, receiveBufferSize, "SO_RCVBUF");
+  }
+
+  if(tcp && fastOpen) {
+#ifdef TCP_FASTOPEN
+  #ifdef __APPLE__
+    set(handle, IPPROTO_TCP, TCP_FASTOPEN, 1, "TCP_FASTOPEN");
+  #else
+    set(handle, IPPROTO_TCP, TCP_FASTOPEN, fastOpenQueue, "TCP_FASTOPEN");
+  #endif
+#else
+    if(isFirstWarning("TCP_FASTOPEN")) {
+      OATPP_LOGD("[oatpp::libressl::SocketOptions::applyToListener()]", "Warning %s is not supported", "TCP_FASTOPEN");
+    }
+#endif
+  }
+
+}
+
+void SocketOptions::applyToAccepted(data::v_io_handle handle, bool tcp) const {
+
+  if(sendBufferSize >= 0) {
+    set(handle, SOL_SOCKET, SO_SNDBUF, sendBufferSize, "SO_SNDBUF");
+  }
+
+  if(receiveBufferSize >= 0) {
+    set(handle, SOL_SOCKET, SO_RCVBUF, receiveBufferSize, "SO_RCVBUF");
+  }
+
+  if(busyPoll >= 0) {
+#ifdef SO_BUSY_POLL
+    set(handle, SOL_SOCKET, SO_BUSY_POLL, busyPoll, "SO_BUSY_POLL");
+#else
+    if(isFirstWarning("SO_BUSY_POLL")) {
+      OATPP_LOGD("[oatpp::libressl::SocketOptions::applyToAccepted()]", "Warning %s is not supported", "SO_BUSY_POLL");
+    }
+#endif
+  }
+
+  if(!tcp) {
+    return;
+  }
+
+  if(noDelay) {
+    set(handle, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+  }
+
+  if(keepAlive) {
+    set(handle, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+    if(keepAliveIdle >= 0) {
+#if defined(TCP_KEEPIDLE)
+      set(handle, IPPROTO_TCP, TCP_KEEPIDLE, keepAliveIdle, "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+      set(handle, IPPROTO_TCP, TCP_KEEPALIVE, keepAliveIdle, "TCP_KEEPALIVE");
+#endif
+    }
+#ifdef TCP_KEEPINTVL
+    if(keepAliveInterval >= 0) {
+      set(handle, IPPROTO_TCP, TCP_KEEPINTVL, keepAliveInterval, "TCP_KEEPINTVL");
+    }
+#endif
+#ifdef TCP_KEEPCNT
+    if(keepAliveCount >= 0) {
+      set(handle, IPPROTO_TCP, TCP_KEEPCNT, keepAliveCount, "TCP_KEEPCNT");
+    }
+#endif
+  }
+
+  if(notSentLowat >= 0) {
+#ifdef TCP_NOTSENT_LOWAT
+    set(handle, IPPROTO_TCP, TCP_NOTSENT_LOWAT, notSentLowat, "TCP_NOTSENT_LOWAT");
+#else
+    if(isFirstWarning("TCP_NOTSENT_LOWAT")) {
+      OATPP_LOGD("[oatpp::libressl::SocketOptions::applyToAccepted()]", "Warning %s is not supported", "TCP_NOTSENT_LOWAT");
+    }
+#endif
+  }
+
+}
+
+void SocketOptions::applyToOutbound(data::v_io_handle handle, bool tcp) const {
+
+  applyToAccepted(handle, tcp);
+
+  if(tcp && fastOpen) {
+#ifdef TCP_FASTOPEN_CONNECT
+    set(handle, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1, "TCP_FASTOPEN_CONNECT");
+#else
+    if(isFirstWarning("TCP_FASTOPEN_CONNECT")) {
+      OATPP_LOGD("[oatpp::libressl::SocketOptions::applyToOutbound()]", "Warning %s is not supported", "TCP_FASTOPEN_CONNECT");
+    }
+#endif
+  }
+
+}
+
+}}
@@ -0,0 +1,168 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_SocketOptions_hpp
+#define oatpp_libressl_SocketOptions_hpp
+
+#include "oatpp/core/data/IODefinitions.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <memory>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Socket options profile applied by &id:oatpp::libressl::server::ConnectionProvider; to the listening socket
+ * and accepted sockets, and by &id:oatpp::libressl::client::ConnectionProvider; to outbound sockets.<br>
+ * Negative values leave the system default. TCP-only options are skipped for unix domain sockets.
+ * Options not supported by the platform are skipped with a log line.
+ */
+class SocketOptions {
+public:
+
+  /**
+   * Set `SO_REUSEADDR` on listening socket. Default `true`.
+   */
+  bool reuseAddress;
+
+  /**
+   * Set `SO_REUSEPORT` on listening socket - several processes may listen on the same port. Default `false`.
+   */
+  bool reusePort;
+
+  /**
+   * Listen backlog. Default `10000`.
+   */
+  v_int32 backlog;
+
+  /**
+   * Set `TCP_NODELAY` - disable Nagle's algorithm. Default `false`.
+   */
+  bool noDelay;
+
+  /**
+   * Set `SO_KEEPALIVE`. Default `false`.
+   */
+  bool keepAlive;
+
+  /**
+   * `TCP_KEEPIDLE` in seconds (`TCP_KEEPALIVE` on macOS).
+   */
+  v_int32 keepAliveIdle;
+
+  /**
+   * `TCP_KEEPINTVL` in seconds.
+   */
+  v_int32 keepAliveInterval;
+
+  /**
+   * `TCP_KEEPCNT`.
+   */
+  v_int32 keepAliveCount;
+
+  /**
+   * `SO_SNDBUF` in bytes.
+   */
+  v_int32 sendBufferSize;
+
+  /**
+   * `SO_RCVBUF` in bytes. Set on listening socket too, so that window scaling is negotiated accordingly.
+   */
+  v_int32 receiveBufferSize;
+
+  /**
+   * TCP Fast Open. Server - `TCP_FASTOPEN` on listening socket with &l:SocketOptions::fastOpenQueue;.
+   * Client - `TCP_FASTOPEN_CONNECT` (Linux), so that TLS ClientHello is sent with SYN. Default `false`.
+   */
+  bool fastOpen;
+
+  /**
+   * Max number of pending TCP Fast Open requests on listening socket. Default `256`.
+   */
+  v_int32 fastOpenQueue;
+
+  /**
+   * `TCP_NOTSENT_LOWAT` in bytes - limit unsent data kept in the kernel, so that new data doesn't queue behind it.
+   */
+  v_int32 notSentLowat;
+
+  /**
+   * `SO_BUSY_POLL` in microseconds (Linux).
+   */
+  v_int32 busyPoll;
+
+private:
+  static void set(data::v_io_handle handle, v_int32 level, v_int32 option, v_int32 value, const char* name);
+public:
+
+  /**
+   * Constructor. System defaults, `SO_REUSEADDR` on listening socket.
+   */
+  SocketOptions();
+
+  /**
+   * Create shared SocketOptions with system defaults.
+   * @return - `std::shared_ptr` to SocketOptions.
+   */
+  static std::shared_ptr<SocketOptions> createShared();
+
+  /**
+   * Profile for latency-sensitive traffic: `TCP_NODELAY`, `TCP_NOTSENT_LOWAT` of 16KB, TCP Fast Open.
+   * @return - `std::shared_ptr` to SocketOptions.
+   */
+  static std::shared_ptr<SocketOptions> createLowLatencyProfile();
+
+  /**
+   * Profile for bulk transfers: 4MB socket buffers, keep-alive.
+   * @return - `std::shared_ptr` to SocketOptions.
+   */
+  static std::shared_ptr<SocketOptions> createThroughputProfile();
+
+  /**
+   * Apply options to listening socket. Must be called before `bind()`.
+   * @param handle - socket.
+   * @param tcp - `false` for unix domain socket.
+   */
+  void applyToListener(data::v_io_handle handle, bool tcp) const;
+
+  /**
+   * Apply options to accepted socket.
+   * @param handle - socket.
+   * @param tcp - `false` for unix domain socket.
+   */
+  void applyToAccepted(data::v_io_handle handle, bool tcp) const;
+
+  /**
+   * Apply options to outbound socket. Must be called before `connect()`.
+   * @param handle - socket.
+   * @param tcp - `false` for unix domain socket.
+   */
+  void applyToOutbound(data::v_io_handle handle, bool tcp) const;
+
+};
+
+}}
+
+#endif /* oatpp_libressl_SocketOptions_hpp */
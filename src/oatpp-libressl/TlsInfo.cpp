@@ -0,0 +1,60 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "TlsInfo.hpp"
+
+#include <cstring>
+
+namespace oatpp { namespace libressl {
+
+namespace {
+
+  oatpp::String toString(const char* str) {
+    if(str == nullptr) {
+      return nullptr;
+    }
+    return oatpp::String(str, (v_int32) std::strlen(str), true);
+  }
+
+}
+
+TlsInfo::TlsInfo(TLSHandle tlsHandle, v_int64 handshakeMicros)
+  : version(toString(tls_conn_version(tlsHandle)))
+  , cipher(toString(tls_conn_cipher(tlsHandle)))
+  , cipherStrength(tls_conn_cipher_strength(tlsHandle))
+  , alpn(toString(tls_conn_alpn_selected(tlsHandle)))
+  , serverName(toString(tls_conn_servername(tlsHandle)))
+  , peerCertHash(tls_peer_cert_provided(tlsHandle) ? toString(tls_peer_cert_hash(tlsHandle)) : nullptr)
+  , peerCertSubject(tls_peer_cert_provided(tlsHandle) ? toString(tls_peer_cert_subject(tlsHandle)) : nullptr)
+  , peerCertIssuer(tls_peer_cert_provided(tlsHandle) ? toString(tls_peer_cert_issuer(tlsHandle)) : nullptr)
+  , sessionResumed(tls_conn_session_resumed(tlsHandle) == 1)
+  , handshakeMicros(handshakeMicros)
+{}
+
+std::shared_ptr<const TlsInfo> TlsInfo::createShared(TLSHandle tlsHandle, v_int64 handshakeMicros) {
+  return std::make_shared<TlsInfo>(tlsHandle, handshakeMicros);
+}
+
+}}
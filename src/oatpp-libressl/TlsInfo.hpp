@@ -0,0 +1,117 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_TlsInfo_hpp
+#define oatpp_libressl_TlsInfo_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <tls.h>
+#include <memory>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Immutable snapshot of the parameters negotiated for a TLS connection.
+ * Created once after the handshake is complete. See &id:oatpp::libressl::Connection::getTlsInfo;.
+ */
+class TlsInfo {
+public:
+  typedef struct tls* TLSHandle;
+public:
+
+  /**
+   * Negotiated protocol version. Ex.: "TLSv1.2".
+   */
+  const oatpp::String version;
+
+  /**
+   * Negotiated cipher suite.
+   */
+  const oatpp::String cipher;
+
+  /**
+   * Strength of the negotiated cipher in bits.
+   */
+  const v_int32 cipherStrength;
+
+  /**
+   * Protocol selected by ALPN. `nullptr` if no protocol was negotiated.
+   */
+  const oatpp::String alpn;
+
+  /**
+   * Server name requested by the client via SNI. `nullptr` if not provided.
+   */
+  const oatpp::String serverName;
+
+  /**
+   * Hash of the peer certificate in form "SHA256:<hex>". `nullptr` if peer provided no certificate.
+   */
+  const oatpp::String peerCertHash;
+
+  /**
+   * Subject of the peer certificate. `nullptr` if peer provided no certificate.
+   */
+  const oatpp::String peerCertSubject;
+
+  /**
+   * Issuer of the peer certificate. `nullptr` if peer provided no certificate.
+   */
+  const oatpp::String peerCertIssuer;
+
+  /**
+   * `true` if TLS session was resumed.
+   */
+  const bool sessionResumed;
+
+  /**
+   * Time in microseconds between the first handshake step and handshake completion.
+   * Time the connection spent waiting in the server queue before its first read/write is not included.
+   */
+  const v_int64 handshakeMicros;
+
+public:
+
+  /**
+   * Constructor. Reads all values from the handle.
+   * @param tlsHandle - `tls*` with completed handshake.
+   * @param handshakeMicros - handshake duration in microseconds.
+   */
+  TlsInfo(TLSHandle tlsHandle, v_int64 handshakeMicros);
+
+  /**
+   * Create shared TlsInfo.
+   * @param tlsHandle - `tls*` with completed handshake.
+   * @param handshakeMicros - handshake duration in microseconds.
+   * @return - `std::shared_ptr` to TlsInfo.
+   */
+  static std::shared_ptr<const TlsInfo> createShared(TLSHandle tlsHandle, v_int64 handshakeMicros);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_TlsInfo_hpp */
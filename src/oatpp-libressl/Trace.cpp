@@ -0,0 +1,262 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace oatpp { namespace libressl {
+
+class Trace::Ring {
+public:
+
+  Ring(v_int64 pCapacity, v_int32 pIndex)
+    : records(new Record[pCapacity])
+    , capacity(pCapacity)
+    , head(0)
+    , owned(true)
+    , index(pIndex)
+  {}
+
+  std::unique_ptr<Record[]> records;
+  const v_int64 capacity;
+  std::atomic<v_int64> head;
+  std::atomic<bool> owned;
+  const v_int32 index;
+
+};
+
+/* rings are never freed - ring of exited thread is handed to the next new thread */
+class Trace::ThreadRing {
+public:
+
+  ThreadRing() {
+    std::lock_guard<std::mutex> lock(RINGS_MUTEX);
+    for(auto r : RINGS) {
+      bool owned = false;
+      if(r->owned.compare_exchange_strong(owned, true)) {
+        ring = r;
+        return;
+      }
+    }
+    ring = new Ring(RING_SIZE.load(std::memory_order_relaxed), (v_int32) RINGS.size());
+    RINGS.push_back(ring);
+  }
+
+  ~ThreadRing() {
+    ring->owned.store(false);
+  }
+
+  Ring* ring;
+
+};
+
+std::atomic<v_int64> Trace::SPAN_COUNTER(0);
+std::atomic<v_int64> Trace::RING_SIZE(16384);
+std::atomic<v_int64> Trace::CLEARED_TICK(0);
+std::mutex Trace::RINGS_MUTEX;
+std::vector<Trace::Ring*> Trace::RINGS;
+
+Trace::Span::Span()
+  : id(SPAN_COUNTER.fetch_add(1, std::memory_order_relaxed) + 1)
+  , recorded(0)
+{}
+
+Trace::Ring* Trace::getThreadRing() {
+  static thread_local ThreadRing threadRing;
+  return threadRing.ring;
+}
+
+void Trace::record(Span& span, Event event) {
+  record(span, event, oatpp::base::Environment::getMicroTickCount());
+}
+
+void Trace::record(Span& span, Event event, v_int64 tick) {
+
+  v_int32 bit = 1 << event;
+  if((span.recorded.load(std::memory_order_relaxed) & bit) != 0) {
+    return;
+  }
+  if((span.recorded.fetch_or(bit, std::memory_order_relaxed) & bit) != 0) {
+    return;
+  }
+
+  Ring* ring = getThreadRing();
+  v_int64 index = ring->head.load(std::memory_order_relaxed);
+  Record& record = ring->records[index % ring->capacity];
+
+  /* pairs with the fence in exportChromeTrace() - reader seeing this record sees head moved past the overwritten one */
+  std::atomic_thread_fence(std::memory_order_release);
+  record.tick.store(tick, std::memory_order_relaxed);
+  record.spanId.store(span.id, std::memory_order_relaxed);
+  record.event.store(event, std::memory_order_relaxed);
+  ring->head.store(index + 1, std::memory_order_release);
+
+}
+
+void Trace::setRingSize(v_int64 size) {
+  RING_SIZE.store(size > 0 ? size : 1, std::memory_order_relaxed);
+}
+
+void Trace::clear() {
+  CLEARED_TICK.store(oatpp::base::Environment::getMicroTickCount(), std::memory_order_relaxed);
+}
+
+namespace {
+
+struct Entry {
+  v_int64 tick;
+  v_int64 spanId;
+  v_int32 event;
+  v_int32 thread;
+};
+
+const char* getPhaseName(v_int32 endEvent) {
+  switch(endEvent) {
+    case Trace::FIRST_BYTE: return "wait-first-byte";
+    case Trace::HANDSHAKE_DONE: return "handshake";
+    case Trace::FIRST_APP_BYTE: return "wait-app-data";
+    case Trace::CLOSE: return "app-data";
+    default: return "connect";
+  }
+}
+
+void appendEvent(std::string& json, const char* name, const char* phase, const Entry& entry, v_int64 duration) {
+  if(json.back() == '}') {
+    json += ",";
+  }
+  json += "\n{\"name\":\"";
+  json += name;
+  json += "\",\"cat\":\"tls\",\"ph\":\"";
+  json += phase;
+  json += "\",\"pid\":1,\"tid\":" + std::to_string(entry.spanId);
+  json += ",\"ts\":" + std::to_string(entry.tick);
+  if(duration >= 0) {
+    json += ",\"dur\":" + std::to_string(duration);
+  } else {
+    json += ",\"s\":\"t\"";
+  }
+  json += ",\"args\":{\"thread\":" + std::to_string(entry.thread) + "}}";
+}
+
+}
+
+oatpp::String Trace::exportChromeTrace(v_int64 minHandshakeMicros) {
+
+  std::vector<Ring*> rings;
+  {
+    std::lock_guard<std::mutex> lock(RINGS_MUTEX);
+    rings = RINGS;
+  }
+
+  v_int64 clearedTick = CLEARED_TICK.load(std::memory_order_relaxed);
+  std::vector<Entry> entries;
+
+  for(auto ring : rings) {
+
+    v_int64 head = ring->head.load(std::memory_order_acquire);
+    v_int64 start = head > ring->capacity ? head - ring->capacity : 0;
+    size_t first = entries.size();
+
+    for(v_int64 i = start; i < head; i ++) {
+      const Record& record = ring->records[i % ring->capacity];
+      Entry entry;
+      entry.tick = record.tick.load(std::memory_order_relaxed);
+      entry.spanId = record.spanId.load(std::memory_order_relaxed);
+      entry.event = record.event.load(std::memory_order_relaxed);
+      entry.thread = ring->index;
+      entries.push_back(entry);
+    }
+
+    /* drop records the owner thread may have overwritten while they were copied */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    v_int64 overwritten = ring->head.load(std::memory_order_relaxed) - ring->capacity + 1;
+    if(overwritten > start) {
+      v_int64 count = std::min(overwritten, head) - start;
+      entries.erase(entries.begin() + first, entries.begin() + first + count);
+    }
+
+  }
+
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [clearedTick](const Entry& e) {
+    return e.tick < clearedTick;
+  }), entries.end());
+
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.spanId != b.spanId ? a.spanId < b.spanId : a.tick < b.tick;
+  });
+
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  size_t spanStart = 0;
+  while(spanStart < entries.size()) {
+
+    size_t spanEnd = spanStart + 1;
+    while(spanEnd < entries.size() && entries[spanEnd].spanId == entries[spanStart].spanId) {
+      spanEnd ++;
+    }
+
+    /* handshake that never completed counts until the last event of the span */
+    v_int64 handshakeEnd = entries[spanEnd - 1].tick;
+    for(size_t i = spanStart; i < spanEnd; i ++) {
+      if(entries[i].event == HANDSHAKE_DONE) {
+        handshakeEnd = entries[i].tick;
+        break;
+      }
+    }
+
+    if(handshakeEnd - entries[spanStart].tick >= minHandshakeMicros) {
+      for(size_t i = spanStart; i < spanEnd; i ++) {
+        appendEvent(json, getEventName((Event) entries[i].event), "i", entries[i], -1);
+        if(i > spanStart) {
+          appendEvent(json, getPhaseName(entries[i].event), "X", entries[i - 1], entries[i].tick - entries[i - 1].tick);
+        }
+      }
+    }
+
+    spanStart = spanEnd;
+
+  }
+
+  json += "\n]}\n";
+  return oatpp::String(json.data(), (v_int32) json.size(), true);
+
+}
+
+const char* Trace::getEventName(Event event) {
+  switch(event) {
+    case ACCEPT: return "accept";
+    case CONNECT: return "connect";
+    case FIRST_BYTE: return "first-byte";
+    case HANDSHAKE_DONE: return "handshake-done";
+    case FIRST_APP_BYTE: return "first-app-byte";
+    case CLOSE: return "close";
+    default: return "unknown";
+  }
+}
+
+}}
@@ -0,0 +1,221 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_Trace_hpp
+#define oatpp_libressl_Trace_hpp
+
+#include "oatpp-libressl/BuildConfig.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/**
+ * Record connection trace event. Expands to nothing unless the module is built with
+ * `-DOATPP_LIBRESSL_TRACE=ON` CMake option.
+ * @param SPAN - &id:oatpp::libressl::Trace::Span; of the connection.
+ * @param EVENT - &id:oatpp::libressl::Trace::Event; name without namespace. Ex.: `ACCEPT`.
+ */
+#ifdef OATPP_LIBRESSL_TRACE
+  #define OATPP_LIBRESSL_TRACE_EVENT(SPAN, EVENT) oatpp::libressl::Trace::record(SPAN, oatpp::libressl::Trace::EVENT)
+#else
+  #define OATPP_LIBRESSL_TRACE_EVENT(SPAN, EVENT)
+#endif
+
+/**
+ * Record connection trace event which happened at `TICK` - for events noticed before the span exists.
+ * Expands to nothing unless the module is built with `-DOATPP_LIBRESSL_TRACE=ON` CMake option.
+ * @param SPAN - &id:oatpp::libressl::Trace::Span; of the connection.
+ * @param EVENT - &id:oatpp::libressl::Trace::Event; name without namespace. Ex.: `ACCEPT`.
+ * @param TICK - time of the event taken with &l:OATPP_LIBRESSL_TRACE_TICK;.
+ */
+#ifdef OATPP_LIBRESSL_TRACE
+  #define OATPP_LIBRESSL_TRACE_EVENT_AT(SPAN, EVENT, TICK) oatpp::libressl::Trace::record(SPAN, oatpp::libressl::Trace::EVENT, TICK)
+#else
+  #define OATPP_LIBRESSL_TRACE_EVENT_AT(SPAN, EVENT, TICK)
+#endif
+
+/**
+ * Current tick for &l:OATPP_LIBRESSL_TRACE_EVENT_AT;. `0` unless the module is built with `-DOATPP_LIBRESSL_TRACE=ON` CMake option.
+ */
+#ifdef OATPP_LIBRESSL_TRACE
+  #define OATPP_LIBRESSL_TRACE_TICK() oatpp::base::Environment::getMicroTickCount()
+#else
+  #define OATPP_LIBRESSL_TRACE_TICK() ((v_int64) 0)
+#endif
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Connection lifecycle tracing. Timestamps of connection phases are recorded into per-thread ring buffers -
+ * no locks and no allocations on the I/O path, the oldest events are overwritten when a ring is full.
+ * Recorded events are exported in Chrome trace JSON format (chrome://tracing, Perfetto) - one row per connection
+ * with phases between consecutive events.<br>
+ * Events are recorded only when the module is built with `-DOATPP_LIBRESSL_TRACE=ON`,
+ * otherwise &l:OATPP_LIBRESSL_TRACE_EVENT; compiles to nothing.
+ */
+class Trace {
+public:
+
+  /**
+   * Traced event. Each event is recorded at most once per connection.
+   */
+  enum Event : v_int32 {
+
+    /**
+     * Server accepted TCP connection.
+     */
+    ACCEPT = 0,
+
+    /**
+     * Client established TCP connection.
+     */
+    CONNECT = 1,
+
+    /**
+     * First byte of peer's handshake flight (ClientHello on server) is available on the socket.
+     * Checked without waiting each time the handshake is stepped - usually missing for blocking connections,
+     * which wait inside the handshake. Not recorded for connections over &id:oatpp::data::stream::IOStream;.
+     */
+    FIRST_BYTE = 2,
+
+    /**
+     * TLS handshake completed (including peer certificate verification).
+     */
+    HANDSHAKE_DONE = 3,
+
+    /**
+     * First byte of application data received.
+     */
+    FIRST_APP_BYTE = 4,
+
+    /**
+     * Connection closed.
+     */
+    CLOSE = 5,
+
+    /**
+     * Number of events.
+     */
+    EVENTS_COUNT = 6
+
+  };
+
+  /**
+   * Trace state of one connection.
+   */
+  struct Span {
+
+    /**
+     * Constructor. Takes next process-unique span id.
+     */
+    Span();
+
+    /**
+     * Process-unique id of the span.
+     */
+    v_int64 id;
+
+    /**
+     * Bit mask of events already recorded for this span.
+     */
+    std::atomic<v_int32> recorded;
+
+  };
+
+private:
+
+  struct Record {
+    std::atomic<v_int64> tick;
+    std::atomic<v_int64> spanId;
+    std::atomic<v_int32> event;
+  };
+
+  class Ring;
+  class ThreadRing;
+
+private:
+  static std::atomic<v_int64> SPAN_COUNTER;
+  static std::atomic<v_int64> RING_SIZE;
+  static std::atomic<v_int64> CLEARED_TICK;
+  static std::mutex RINGS_MUTEX;
+  static std::vector<Ring*> RINGS;
+private:
+  static Ring* getThreadRing();
+public:
+
+  /**
+   * Record event of the span to the ring of the calling thread. Repeated events of the span are ignored.
+   * Use &l:OATPP_LIBRESSL_TRACE_EVENT; macro instead of calling it directly.
+   * @param span - &l:Trace::Span;.
+   * @param event - &l:Trace::Event;.
+   */
+  static void record(Span& span, Event event);
+
+  /**
+   * Record event of the span which happened at `tick`. Repeated events of the span are ignored.
+   * Use &l:OATPP_LIBRESSL_TRACE_EVENT_AT; macro instead of calling it directly.
+   * @param span - &l:Trace::Span;.
+   * @param event - &l:Trace::Event;.
+   * @param tick - time of the event in microseconds - &id:oatpp::base::Environment::getMicroTickCount;.
+   */
+  static void record(Span& span, Event event, v_int64 tick);
+
+  /**
+   * Set number of events each per-thread ring holds. Applies to rings created after the call.
+   * Default is `16384`.
+   * @param size - number of events.
+   */
+  static void setRingSize(v_int64 size);
+
+  /**
+   * Drop all events recorded so far from subsequent exports.
+   */
+  static void clear();
+
+  /**
+   * Export recorded events as Chrome trace JSON.
+   * Timestamps are microseconds of `oatpp::base::Environment::getMicroTickCount()`.
+   * @param minHandshakeMicros - export only connections whose time from accept/connect to handshake completion
+   * is at least this value. `0` - export all connections.
+   * @return - JSON document.
+   */
+  static oatpp::String exportChromeTrace(v_int64 minHandshakeMicros = 0);
+
+  /**
+   * Get name of the event.
+   * @param event - &l:Trace::Event;.
+   * @return - name of the event.
+   */
+  static const char* getEventName(Event event);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_Trace_hpp */
@@ -0,0 +1,117 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "UnixSocketAddress.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oatpp { namespace libressl {
+
+bool UnixSocketAddress::isAbstract(const oatpp::String& path) {
+  return path->getSize() > 0 && path->getData()[0] == '@';
+}
+
+socklen_t UnixSocketAddress::fill(const oatpp::String& path, struct sockaddr_un* addr) {
+
+  std::memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+
+  v_int32 size = path->getSize();
+
+  if(size == 0 || size >= (v_int32) sizeof(addr->sun_path)) {
+    return 0;
+  }
+
+  std::memcpy(addr->sun_path, path->getData(), size);
+
+  if(isAbstract(path)) {
+#if defined(__linux__)
+    addr->sun_path[0] = '\0';
+    return (socklen_t) (offsetof(struct sockaddr_un, sun_path) + size);
+#else
+    return 0;
+#endif
+  }
+
+  return (socklen_t) sizeof(struct sockaddr_un);
+
+}
+
+oatpp::String UnixSocketAddress::getPath(const struct sockaddr_un* addr, socklen_t length) {
+
+  v_int32 size = (v_int32) length - (v_int32) offsetof(struct sockaddr_un, sun_path);
+  if(size <= 0) {
+    return nullptr;
+  }
+
+  if(addr->sun_path[0] == '\0') {
+    std::string path(addr->sun_path, size);
+    path[0] = '@';
+    return oatpp::String(path.data(), (v_int32) path.size(), true);
+  }
+
+  return oatpp::String(addr->sun_path, (v_int32) strnlen(addr->sun_path, size), true);
+
+}
+
+bool UnixSocketAddress::removeStale(const oatpp::String& path) {
+
+  if(isAbstract(path)) {
+    return true;
+  }
+
+  struct stat info;
+  if(lstat(path->c_str(), &info) != 0) {
+    return errno == ENOENT;
+  }
+
+  if(!S_ISSOCK(info.st_mode)) {
+    return false;
+  }
+
+  struct sockaddr_un addr;
+  socklen_t addrLength = fill(path, &addr);
+  if(addrLength == 0) {
+    return false;
+  }
+
+  int handle = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(handle < 0) {
+    return false;
+  }
+  bool refused = connect(handle, (struct sockaddr*) &addr, addrLength) != 0 && errno == ECONNREFUSED;
+  ::close(handle);
+
+  /* nobody listens on it - socket file of exited process */
+  return refused && (::unlink(path->c_str()) == 0 || errno == ENOENT);
+
+}
+
+}}
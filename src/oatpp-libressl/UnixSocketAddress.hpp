@@ -0,0 +1,79 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_UnixSocketAddress_hpp
+#define oatpp_libressl_UnixSocketAddress_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace oatpp { namespace libressl {
+
+/**
+ * Helper to build `sockaddr_un` for unix domain sockets.
+ * Paths starting with '@' denote Linux abstract namespace sockets - '@' is replaced with '\0'.
+ */
+class UnixSocketAddress {
+public:
+
+  /**
+   * Check if path denotes abstract namespace socket.
+   * @param path - socket path.
+   * @return - `true` if path starts with '@'.
+   */
+  static bool isAbstract(const oatpp::String& path);
+
+  /**
+   * Fill `sockaddr_un` structure.
+   * @param path - socket path. Start path with '@' for abstract namespace socket.
+   * @param addr - structure to fill.
+   * @return - length of the address to pass to `bind()`/`connect()`. `0` if path is too long or is not supported.
+   */
+  static socklen_t fill(const oatpp::String& path, struct sockaddr_un* addr);
+
+  /**
+   * Get path from `sockaddr_un` structure - ex.: returned by `getsockname()`.
+   * @param addr - address.
+   * @param length - length of the address.
+   * @return - socket path. Abstract namespace path starts with '@'. `nullptr` for unnamed socket.
+   */
+  static oatpp::String getPath(const struct sockaddr_un* addr, socklen_t length);
+
+  /**
+   * Prepare path for `bind()` - remove socket file left by a process which is no longer listening on it.
+   * Files which are not sockets, and sockets which accept connections are left in place.
+   * @param path - socket path.
+   * @return - `true` if path is free to bind (abstract path, no file or stale socket removed).
+   * `false` if file must not be removed.
+   */
+  static bool removeStale(const oatpp::String& path);
+
+};
+
+}}
+
+#endif /* oatpp_libressl_UnixSocketAddress_hpp */
@@ -25,6 +25,7 @@
 #include "ConnectionProvider.hpp"
 
 #include "oatpp-libressl/Connection.hpp"
+#include "oatpp-libressl/UnixSocketAddress.hpp"
 
 #include "oatpp/core/utils/ConversionUtils.hpp"
 
@@ -45,6 +46,7 @@ ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
   : m_config(config)
   , m_host(host)
   , m_port(port)
+  , m_socketOptions(SocketOptions::createShared())
 {
   
   setProperty(PROPERTY_HOST, m_host);
@@ -60,31 +62,244 @@ ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
   }
 }
 
+ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
+                                       const std::shared_ptr<oatpp::network::ClientConnectionProvider>& streamProvider,
+                                       const oatpp::String& serverName)
+  : m_config(config)
+  , m_host(serverName)
+  , m_port(0)
+  , m_streamProvider(streamProvider)
+  , m_socketOptions(SocketOptions::createShared())
+{
+  setProperty(PROPERTY_HOST, m_host);
+  setProperty(PROPERTY_PORT, streamProvider->getProperty(PROPERTY_PORT));
+}
+
+ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
+                                       const oatpp::String& unixSocketPath,
+                                       const oatpp::String& serverName)
+  : m_config(config)
+  , m_host(serverName)
+  , m_port(0)
+  , m_unixPath(unixSocketPath)
+  , m_socketOptions(SocketOptions::createShared())
+{
+
+  setProperty(PROPERTY_HOST, m_unixPath);
+  setProperty(PROPERTY_PORT, "0");
+
+  auto calback = CRYPTO_get_locking_callback();
+  if(!calback) {
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::ConnectionProvider()]",
+               "WARNING. libressl. CRYPTO_set_locking_callback is NOT set. "
+               "This can cause problems using libressl in multithreaded environment! "
+               "Please call oatpp::libressl::Callbacks::setDefaultCallbacks() or "
+               "consider setting custom locking_callback.");
+  }
+}
+
 std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
                                                                      const oatpp::String& host,
                                                                      v_word16 port) {
   return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, host, port));
 }
-  
+
+std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
+                                                                     const oatpp::String& unixSocketPath,
+                                                                     const oatpp::String& serverName) {
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, unixSocketPath, serverName));
+}
+
+std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
+                                                                     const std::shared_ptr<oatpp::network::ClientConnectionProvider>& streamProvider,
+                                                                     const oatpp::String& serverName) {
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, streamProvider, serverName));
+}
+
+socklen_t ConnectionProvider::resolveAddress(const oatpp::String& host,
+                                             v_word16 port,
+                                             const oatpp::String& unixPath,
+                                             struct sockaddr_storage* address)
+{
+
+  bzero(address, sizeof(struct sockaddr_storage));
+
+  if(unixPath) {
+    return UnixSocketAddress::fill(unixPath, (struct sockaddr_un*) address);
+  }
+
+  struct hostent* hostEntry = gethostbyname((const char*) host->getData());
+
+  if ((hostEntry == NULL) || (hostEntry->h_addr == NULL)) {
+    return 0;
+  }
+
+  struct sockaddr_in* inAddress = (struct sockaddr_in*) address;
+  inAddress->sin_family = AF_INET;
+  inAddress->sin_port = htons(port);
+  memcpy(&inAddress->sin_addr, hostEntry->h_addr, hostEntry->h_length);
+
+  return sizeof(struct sockaddr_in);
+
+}
+
+std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getStreamConnection() {
+
+  auto stream = m_streamProvider->getConnection();
+  if(!stream) {
+    return nullptr;
+  }
+
+  Connection::TLSHandle tlsHandle = tls_client();
+
+  tls_configure(tlsHandle, m_config->getTLSConfig());
+
+  if(tls_connect_cbs(tlsHandle, Connection::readCallback, Connection::writeCallback, stream.get(), (const char*) m_host->getData()) < 0) {
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getStreamConnection()]", "TLS could not connect. %s", tls_error(tlsHandle));
+    tls_free(tlsHandle);
+    return nullptr;
+  }
+
+  auto connection = Connection::createShared(tlsHandle, stream);
+  OATPP_LIBRESSL_TRACE_EVENT(connection->getTraceSpan(), CONNECT);
+  return connection;
+
+}
+
+oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> ConnectionProvider::getStreamConnectionAsync() {
+
+  class StreamConnectCoroutine : public oatpp::async::CoroutineWithResult<StreamConnectCoroutine, const std::shared_ptr<oatpp::data::stream::IOStream>&> {
+  private:
+    std::shared_ptr<oatpp::network::ClientConnectionProvider> m_streamProvider;
+    oatpp::String m_host;
+    std::shared_ptr<Config> m_config;
+  public:
+
+    StreamConnectCoroutine(const std::shared_ptr<oatpp::network::ClientConnectionProvider>& streamProvider,
+                           const oatpp::String& host,
+                           const std::shared_ptr<Config>& config)
+      : m_streamProvider(streamProvider)
+      , m_host(host)
+      , m_config(config)
+    {}
+
+    Action act() override {
+      return m_streamProvider->getConnectionAsync().callbackTo(&StreamConnectCoroutine::onStream);
+    }
+
+    Action onStream(const std::shared_ptr<oatpp::data::stream::IOStream>& stream) {
+
+      Connection::TLSHandle tlsHandle = tls_client();
+
+      tls_configure(tlsHandle, m_config->getTLSConfig());
+
+      if(tls_connect_cbs(tlsHandle, Connection::readCallback, Connection::writeCallback, stream.get(), (const char*) m_host->getData()) < 0) {
+        OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){StreamConnectCoroutine::onStream()}]", "TLS could not connect. %s", tls_error(tlsHandle));
+        tls_free(tlsHandle);
+        return error<Error>("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){StreamConnectCoroutine::onStream()}]: Can't secure connect");
+      }
+
+      /* handshake is completed by Connection on first read/write */
+      auto connection = Connection::createShared(tlsHandle, stream);
+      OATPP_LIBRESSL_TRACE_EVENT(connection->getTraceSpan(), CONNECT);
+      return _return(connection);
+
+    }
+
+  };
+
+  return StreamConnectCoroutine::startForResult(m_streamProvider, m_host, m_config);
+
+}
+
+ConnectionProvider::~ConnectionProvider() {
+  close();
+}
+
+void ConnectionProvider::setReserve(const std::shared_ptr<oatpp::async::Executor>& executor, v_int32 minIdle, v_int64 maxIdleMicros) {
+  if(m_reserve) {
+    m_reserve->stop();
+  }
+  /* reserve is stopped in close() - called from destructor - and stop() waits for the calls in progress */
+  m_reserve = ConnectionReserve::createShared(executor, minIdle, maxIdleMicros, [this]() {
+    return createConnectionAsync();
+  });
+  m_reserve->start();
+}
+
+void ConnectionProvider::setSocketOptions(const std::shared_ptr<SocketOptions>& socketOptions) {
+  m_socketOptions = socketOptions ? socketOptions : SocketOptions::createShared();
+}
+
+void ConnectionProvider::close() {
+  if(m_reserve) {
+    m_reserve->stop();
+  }
+}
+
 std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getConnection(){
+
+  if(m_reserve) {
+    auto connection = m_reserve->take();
+    if(connection) {
+      /* reserved connections are created non-blocking */
+      if(connection->getHandle() >= 0) {
+        fcntl(connection->getHandle(), F_SETFL, 0);
+      }
+      return connection;
+    }
+  }
+
+  return createConnection();
+
+}
+
+oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> ConnectionProvider::getConnectionAsync() {
+
+  class ReadyConnectionCoroutine : public oatpp::async::CoroutineWithResult<ReadyConnectionCoroutine, const std::shared_ptr<oatpp::data::stream::IOStream>&> {
+  private:
+    std::shared_ptr<oatpp::data::stream::IOStream> m_connection;
+  public:
+
+    ReadyConnectionCoroutine(const std::shared_ptr<oatpp::data::stream::IOStream>& connection)
+      : m_connection(connection)
+    {}
+
+    Action act() override {
+      return _return(m_connection);
+    }
+
+  };
+
+  if(m_reserve) {
+    std::shared_ptr<oatpp::data::stream::IOStream> connection = m_reserve->take();
+    if(connection) {
+      return ReadyConnectionCoroutine::startForResult(connection);
+    }
+  }
+
+  return createConnectionAsync();
+
+}
+
+std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::createConnection(){
+
+  if(m_streamProvider) {
+    return getStreamConnection();
+  }
   
-  struct hostent* host = gethostbyname((const char*) m_host->getData());
-  struct sockaddr_in client;
+  struct sockaddr_storage client;
+  socklen_t clientLength = resolveAddress(m_host, m_port, m_unixPath, &client);
   
-  if ((host == NULL) || (host->h_addr == NULL)) {
-    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnection()]", "Error retrieving DNS information.");
+  if (clientLength == 0) {
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::createConnection()]", "Error retrieving address information.");
     return nullptr;
   }
   
-  bzero(&client, sizeof(client));
-  client.sin_family = AF_INET;
-  client.sin_port = htons(m_port);
-  memcpy(&client.sin_addr, host->h_addr, host->h_length);
-  
-  data::v_io_handle clientHandle = socket(AF_INET, SOCK_STREAM, 0);
+  data::v_io_handle clientHandle = socket(client.ss_family, SOCK_STREAM, 0);
   
   if (clientHandle < 0) {
-    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnection()]", "Error creating socket.");
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::createConnection()]", "Error creating socket.");
     return nullptr;
   }
   
@@ -92,13 +307,15 @@ std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getConnection
   int yes = 1;
   v_int32 ret = setsockopt(clientHandle, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(int));
   if(ret < 0) {
-    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnection()]", "Warning failed to set %s for socket", "SO_NOSIGPIPE");
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::createConnection()]", "Warning failed to set %s for socket", "SO_NOSIGPIPE");
   }
 #endif
+
+  m_socketOptions->applyToOutbound(clientHandle, !m_unixPath);
   
-  if (connect(clientHandle, (struct sockaddr *)&client, sizeof(client)) != 0 ) {
+  if (connect(clientHandle, (struct sockaddr *)&client, clientLength) != 0 ) {
     ::close(clientHandle);
-    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnection()]", "Could not connect");
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::createConnection()]", "Could not connect");
     return nullptr;
   }
   
@@ -107,35 +324,48 @@ std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getConnection
   tls_configure(tlsHandle, m_config->getTLSConfig());
   
   if(tls_connect_socket(tlsHandle, clientHandle, (const char*) m_host->getData()) < 0) {
-    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnection()]", "TLS could not connect. %s", tls_error(tlsHandle));
+    OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::createConnection()]", "TLS could not connect. %s", tls_error(tlsHandle));
     ::close(clientHandle);
     tls_close(tlsHandle);
     tls_free(tlsHandle);
     return nullptr;
   }
   
-  return Connection::createShared(tlsHandle, clientHandle);
+  auto connection = Connection::createShared(tlsHandle, clientHandle);
+  OATPP_LIBRESSL_TRACE_EVENT(connection->getTraceSpan(), CONNECT);
+  return connection;
   
 }
 
-oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> ConnectionProvider::getConnectionAsync() {
+oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> ConnectionProvider::createConnectionAsync() {
+
+  if(m_streamProvider) {
+    return getStreamConnectionAsync();
+  }
   
   class ConnectCoroutine : public oatpp::async::CoroutineWithResult<ConnectCoroutine, const std::shared_ptr<oatpp::data::stream::IOStream>&> {
   private:
     oatpp::String m_host;
     v_int32 m_port;
+    oatpp::String m_unixPath;
     std::shared_ptr<Config> m_config;
+    std::shared_ptr<SocketOptions> m_socketOptions;
     Connection::TLSHandle m_tlsHandle;
     data::v_io_handle m_clientHandle;
-    struct sockaddr_in m_client;
+    struct sockaddr_storage m_client;
+    socklen_t m_clientLength;
   public:
     
     ConnectCoroutine(const oatpp::String& host,
                      v_int32 port,
-                     const std::shared_ptr<Config>& config)
+                     const oatpp::String& unixPath,
+                     const std::shared_ptr<Config>& config,
+                     const std::shared_ptr<SocketOptions>& socketOptions)
       : m_host(host)
       , m_port(port)
+      , m_unixPath(unixPath)
       , m_config(config)
+      , m_socketOptions(socketOptions)
       , m_tlsHandle(nullptr)
     {}
     
@@ -148,18 +378,13 @@ oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::strea
     
     Action act() override {
       
-      struct hostent* host = gethostbyname((const char*) m_host->getData());
+      m_clientLength = resolveAddress(m_host, m_port, m_unixPath, &m_client);
       
-      if ((host == NULL) || (host->h_addr == NULL)) {
-        return error<Error>("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::act()}]: Error retrieving DNS information.");
+      if (m_clientLength == 0) {
+        return error<Error>("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::act()}]: Error retrieving address information.");
       }
       
-      bzero(&m_client, sizeof(m_client));
-      m_client.sin_family = AF_INET;
-      m_client.sin_port = htons(m_port);
-      memcpy(&m_client.sin_addr, host->h_addr, host->h_length);
-      
-      m_clientHandle = socket(AF_INET, SOCK_STREAM, 0);
+      m_clientHandle = socket(m_client.ss_family, SOCK_STREAM, 0);
       
       if (m_clientHandle < 0) {
         return error<Error>("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::act()}]: Error creating socket.");
@@ -174,6 +399,8 @@ oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::strea
         OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::act()}]", "Warning failed to set %s for socket", "SO_NOSIGPIPE");
       }
 #endif
+
+      m_socketOptions->applyToOutbound(m_clientHandle, !m_unixPath);
       
       return yieldTo(&ConnectCoroutine::doConnect);
       
@@ -181,7 +408,7 @@ oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::strea
     
     Action doConnect() {
       errno = 0;
-      auto res = connect(m_clientHandle, (struct sockaddr *)&m_client, sizeof(m_client));
+      auto res = connect(m_clientHandle, (struct sockaddr *)&m_client, m_clientLength);
       if(res == 0 || errno == EISCONN) {
         //return _return(Connection::createShared(m_clientHandle));
         if(m_tlsHandle == nullptr) {
@@ -205,10 +432,12 @@ oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::strea
         OATPP_LOGD("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::secureConnection()}]", "TLS could not connect. %s, %d", tls_error(m_tlsHandle), res);
         tls_close(m_tlsHandle);
         tls_free(m_tlsHandle);
+        m_tlsHandle = nullptr;
         ::close(m_clientHandle);
         return error<Error>("[oatpp::libressl::client::ConnectionProvider::getConnectionAsync(){ConnectCoroutine::secureConnection()}]: Can't secure connect");
       }
       auto connection = Connection::createShared(m_tlsHandle, m_clientHandle);
+      OATPP_LIBRESSL_TRACE_EVENT(connection->getTraceSpan(), CONNECT);
       m_tlsHandle = nullptr; // prevent m_tlsHandle to be freed by Coroutine
       return _return(connection);
       
@@ -216,7 +445,7 @@ oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::strea
     
   };
   
-  return ConnectCoroutine::startForResult(m_host, m_port, m_config);
+  return ConnectCoroutine::startForResult(m_host, m_port, m_unixPath, m_config, m_socketOptions);
   
 }
   
@@ -25,21 +25,40 @@
 #ifndef oatpp_libressl_client_ConnectionProvider_hpp
 #define oatpp_libressl_client_ConnectionProvider_hpp
 
+#include "oatpp-libressl/client/ConnectionReserve.hpp"
 #include "oatpp-libressl/Config.hpp"
+#include "oatpp-libressl/SocketOptions.hpp"
 
 #include "oatpp/network/ConnectionProvider.hpp"
 
+#include <sys/socket.h>
+
 namespace oatpp { namespace libressl { namespace client {
 
 /**
  * Libressl client connection provider.
  * Extends &id:oatpp::base::Countable;, &id:oatpp::network::ClientConnectionProvider;.
+ * Connects TLS either over its own TCP or unix domain socket, or over streams provided by
+ * other &id:oatpp::network::ClientConnectionProvider; (in-memory pipes, unix sockets, TLS-in-TLS, etc.).
  */
 class ConnectionProvider : public base::Countable, public oatpp::network::ClientConnectionProvider {
 private:
   std::shared_ptr<Config> m_config;
   oatpp::String m_host;
   v_word16 m_port;
+  oatpp::String m_unixPath;
+  std::shared_ptr<oatpp::network::ClientConnectionProvider> m_streamProvider;
+  std::shared_ptr<ConnectionReserve> m_reserve;
+  std::shared_ptr<SocketOptions> m_socketOptions;
+private:
+  static socklen_t resolveAddress(const oatpp::String& host,
+                                  v_word16 port,
+                                  const oatpp::String& unixPath,
+                                  struct sockaddr_storage* address);
+  std::shared_ptr<IOStream> getStreamConnection();
+  oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> getStreamConnectionAsync();
+  std::shared_ptr<IOStream> createConnection();
+  oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> createConnectionAsync();
 public:
   /**
    * Constructor.
@@ -48,6 +67,24 @@ public:
    * @param port - server port.
    */
   ConnectionProvider(const std::shared_ptr<Config>& config, const oatpp::String& host, v_word16 port);
+
+  /**
+   * Constructor. Connect to unix domain socket.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param unixSocketPath - path of the socket. Start path with '@' to use Linux abstract namespace.
+   * @param serverName - server name used for SNI and certificate verification.
+   */
+  ConnectionProvider(const std::shared_ptr<Config>& config, const oatpp::String& unixSocketPath, const oatpp::String& serverName);
+
+  /**
+   * Constructor.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param streamProvider - provider of underlying transport streams. TLS is run over these streams via libtls callback I/O.
+   * @param serverName - server name used for SNI and certificate verification.
+   */
+  ConnectionProvider(const std::shared_ptr<Config>& config,
+                     const std::shared_ptr<oatpp::network::ClientConnectionProvider>& streamProvider,
+                     const oatpp::String& serverName);
 public:
 
   /**
@@ -62,12 +99,71 @@ public:
                                                           v_word16 port);
 
   /**
-   * Implements &id:oatpp::network::ConnectionProvider::close;. Here does nothing.
+   * Create shared ConnectionProvider connecting to unix domain socket.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param unixSocketPath - path of the socket. Start path with '@' to use Linux abstract namespace.
+   * @param serverName - server name used for SNI and certificate verification.
+   * @return - `std::shared_ptr` to ConnectionProvider.
+   */
+  static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
+                                                          const oatpp::String& unixSocketPath,
+                                                          const oatpp::String& serverName);
+
+  /**
+   * Create shared ConnectionProvider running TLS over streams of other provider.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param streamProvider - provider of underlying transport streams.
+   * @param serverName - server name used for SNI and certificate verification.
+   * @return - `std::shared_ptr` to ConnectionProvider.
    */
-  void close() override {
-    // DO NOTHING
+  static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
+                                                          const std::shared_ptr<oatpp::network::ClientConnectionProvider>& streamProvider,
+                                                          const oatpp::String& serverName);
+
+  /**
+   * Virtual destructor.
+   */
+  ~ConnectionProvider();
+
+  /**
+   * Keep a reserve of pre-warmed (connected and handshaked) idle connections.
+   * &l:ConnectionProvider::getConnection (); and &l:ConnectionProvider::getConnectionAsync (); take connections
+   * from the reserve when available, and the reserve is refilled in background on the executor.
+   * @param executor - &id:oatpp::async::Executor; to run background connects on.
+   * @param minIdle - number of idle connections to keep ready.
+   * @param maxIdleMicros - rotate idle connection after this time. Should be less than server's idle timeout.
+   * `0` - don't rotate.
+   */
+  void setReserve(const std::shared_ptr<oatpp::async::Executor>& executor, v_int32 minIdle, v_int64 maxIdleMicros);
+
+  /**
+   * Get reserve of pre-warmed connections.
+   * @return - &id:oatpp::libressl::client::ConnectionReserve;. `nullptr` if reserve is not set.
+   */
+  std::shared_ptr<ConnectionReserve> getReserve() {
+    return m_reserve;
   }
 
+  /**
+   * Set options of outbound sockets. Applies to connections created after the call.
+   * Set &id:oatpp::libressl::SocketOptions::fastOpen; to send TLS ClientHello with SYN.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions;.
+   */
+  void setSocketOptions(const std::shared_ptr<SocketOptions>& socketOptions);
+
+  /**
+   * Get options of outbound sockets.
+   * @return - &id:oatpp::libressl::SocketOptions;.
+   */
+  std::shared_ptr<SocketOptions> getSocketOptions() {
+    return m_socketOptions;
+  }
+
+  /**
+   * Implements &id:oatpp::network::ConnectionProvider::close;. Stops connection reserve if set.
+   */
+  void close() override;
+
   /**
    * Get connection.
    * @return - `std::shared_ptr` to &id:oatpp::data::stream::IOStream;.
@@ -0,0 +1,337 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ConnectionReserve.hpp"
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <vector>
+
+namespace oatpp { namespace libressl { namespace client {
+
+namespace {
+
+const v_int64 RETRY_MIN_MICROS = 100 * 1000;
+const v_int64 RETRY_MAX_MICROS = 30 * 1000 * 1000;
+const v_int64 CHECK_INTERVAL_MIN_MICROS = 10 * 1000;
+const v_int64 CHECK_INTERVAL_MAX_MICROS = 1000 * 1000;
+
+/* raw socket check - no TLS I/O, so it never consumes application data */
+bool isOpen(data::v_io_handle handle) {
+
+  struct pollfd pfd;
+  pfd.fd = handle;
+  pfd.events = POLLIN;
+#ifdef POLLRDHUP
+  /* peer shutdown behind pending records - ex.: close_notify followed by FIN */
+  pfd.events |= POLLRDHUP;
+#endif
+  pfd.revents = 0;
+
+  if(poll(&pfd, 1, 0) < 0) {
+    return false;
+  }
+
+  if((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+    return false;
+  }
+#ifdef POLLRDHUP
+  if((pfd.revents & POLLRDHUP) != 0) {
+    return false;
+  }
+#endif
+
+  if((pfd.revents & POLLIN) == 0) {
+    return true;
+  }
+
+  /* pending records (ex.: TLS 1.3 NewSessionTicket) are left to libtls - only EOF and errors matter here */
+  v_char8 byte;
+  auto peeked = recv(handle, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  if(peeked == 0) {
+    return false;
+  }
+  if(peeked < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+  return true;
+
+}
+
+}
+
+class ConnectionReserve::RefillCoroutine : public oatpp::async::Coroutine<RefillCoroutine> {
+private:
+  std::shared_ptr<ConnectionReserve> m_reserve;
+  std::shared_ptr<Connection> m_connection;
+  bool m_handshakeDone;
+public:
+
+  RefillCoroutine(const std::shared_ptr<ConnectionReserve>& reserve)
+    : m_reserve(reserve)
+    , m_handshakeDone(false)
+  {}
+
+  ~RefillCoroutine() {
+    m_reserve->onRefillDone(m_handshakeDone ? m_connection : nullptr);
+  }
+
+  Action act() override {
+
+    ConnectFunction connect;
+    {
+      std::lock_guard<std::mutex> lock(m_reserve->m_lock);
+      if(!m_reserve->m_running) {
+        return finish();
+      }
+      connect = m_reserve->m_connect;
+      m_reserve->m_connecting ++;
+    }
+
+    /* called outside of the lock - stop() waits for it, so that connect function doesn't outlive its owner */
+    try {
+      auto starter = connect();
+      m_reserve->onConnectCalled();
+      return starter.callbackTo(&RefillCoroutine::onConnected);
+    } catch (...) {
+      m_reserve->onConnectCalled();
+      throw;
+    }
+
+  }
+
+  Action onConnected(const std::shared_ptr<oatpp::data::stream::IOStream>& connection) {
+    m_connection = std::static_pointer_cast<Connection>(connection);
+    return yieldTo(&RefillCoroutine::handshake);
+  }
+
+  Action handshake() {
+    auto res = m_connection->handshake();
+    if(res == data::IOError::WAIT_RETRY) {
+      return waitRetry();
+    }
+    m_handshakeDone = (res == 0);
+    return finish();
+  }
+
+};
+
+ConnectionReserve::ConnectionReserve(const std::shared_ptr<oatpp::async::Executor>& executor,
+                                     v_int32 minIdle,
+                                     v_int64 maxIdleMicros,
+                                     const ConnectFunction& connect)
+  : m_executor(executor)
+  , m_minIdle(minIdle)
+  , m_maxIdleMicros(maxIdleMicros)
+  , m_connect(connect)
+  , m_pending(0)
+  , m_connecting(0)
+  , m_failures(0)
+  , m_retryAt(0)
+  , m_running(false)
+{}
+
+std::shared_ptr<ConnectionReserve> ConnectionReserve::createShared(const std::shared_ptr<oatpp::async::Executor>& executor,
+                                                                   v_int32 minIdle,
+                                                                   v_int64 maxIdleMicros,
+                                                                   const ConnectFunction& connect)
+{
+  return std::make_shared<ConnectionReserve>(executor, minIdle, maxIdleMicros, connect);
+}
+
+ConnectionReserve::~ConnectionReserve() {
+  stop();
+}
+
+bool ConnectionReserve::isExpired(const Entry& entry, v_int64 tick) {
+  return m_maxIdleMicros > 0 && tick - entry.addedAt >= m_maxIdleMicros;
+}
+
+bool ConnectionReserve::isUsable(const Entry& entry, v_int64 tick) {
+  if(isExpired(entry, tick)) {
+    return false;
+  }
+  data::v_io_handle handle = entry.connection->getHandle();
+  return handle < 0 || isOpen(handle);
+}
+
+void ConnectionReserve::prune(v_int64 tick) {
+
+  std::vector<std::shared_ptr<Connection>> idle;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for(auto& entry : m_connections) {
+      idle.push_back(entry.connection);
+    }
+  }
+
+  /* sockets are checked outside of the lock - take() is not blocked meanwhile */
+  std::vector<std::shared_ptr<Connection>> closed;
+  for(auto& connection : idle) {
+    if(connection->getHandle() >= 0 && !isOpen(connection->getHandle())) {
+      closed.push_back(connection);
+    }
+  }
+
+  /* removed connections are destroyed after the lock is released - destructor sends close_notify */
+  std::list<Entry> removed;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_connections.begin();
+    while(it != m_connections.end()) {
+      auto current = it ++;
+      if(isExpired(*current, tick) || std::find(closed.begin(), closed.end(), current->connection) != closed.end()) {
+        removed.splice(removed.end(), m_connections, current);
+      }
+    }
+  }
+
+}
+
+void ConnectionReserve::onConnectCalled() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_connecting --;
+  m_condition.notify_all();
+}
+
+void ConnectionReserve::onRefillDone(const std::shared_ptr<Connection>& connection) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_pending --;
+  if(connection) {
+    m_failures = 0;
+    if(m_running) {
+      m_connections.push_back({connection, oatpp::base::Environment::getMicroTickCount()});
+    }
+  } else {
+    v_int64 backoff = RETRY_MAX_MICROS;
+    if(m_failures < 20) {
+      backoff = std::min(RETRY_MIN_MICROS << m_failures, RETRY_MAX_MICROS);
+    }
+    m_failures ++;
+    m_retryAt = oatpp::base::Environment::getMicroTickCount() + backoff;
+  }
+  m_condition.notify_all();
+}
+
+void ConnectionReserve::run() {
+
+  v_int64 checkInterval = m_maxIdleMicros > 0 ? m_maxIdleMicros / 4 : CHECK_INTERVAL_MAX_MICROS;
+  checkInterval = std::max(CHECK_INTERVAL_MIN_MICROS, std::min(checkInterval, CHECK_INTERVAL_MAX_MICROS));
+
+  std::unique_lock<std::mutex> lock(m_lock);
+
+  while(m_running) {
+
+    v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+    v_int64 wait = checkInterval;
+
+    lock.unlock();
+    prune(tick);
+    lock.lock();
+
+    if(!m_running) {
+      break;
+    }
+
+    v_int32 deficit = m_minIdle - (v_int32) m_connections.size() - m_pending;
+
+    if(deficit > 0 && m_failures > 0) {
+      if(tick < m_retryAt) {
+        wait = std::min(wait, m_retryAt - tick);
+        deficit = 0;
+      } else {
+        /* upstream failed recently - probe with one connect at a time */
+        deficit = m_pending == 0 ? 1 : 0;
+      }
+    }
+
+    if(deficit > 0) {
+      m_pending += deficit;
+      lock.unlock();
+      for(v_int32 i = 0; i < deficit; i ++) {
+        m_executor->execute<RefillCoroutine>(shared_from_this());
+      }
+      lock.lock();
+    }
+
+    m_condition.wait_for(lock, std::chrono::microseconds(std::max(wait, CHECK_INTERVAL_MIN_MICROS)));
+
+  }
+
+}
+
+void ConnectionReserve::start() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if(!m_running) {
+    m_running = true;
+    m_thread = std::thread(&ConnectionReserve::run, this);
+  }
+}
+
+void ConnectionReserve::stop() {
+  std::list<Entry> connections;
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_running = false;
+    while(m_connecting > 0) {
+      m_condition.wait(lock);
+    }
+    m_connect = nullptr;
+    connections.swap(m_connections);
+    m_condition.notify_all();
+  }
+  if(m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+std::shared_ptr<Connection> ConnectionReserve::take() {
+  v_int64 tick = oatpp::base::Environment::getMicroTickCount();
+  while(true) {
+    Entry entry;
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      if(m_connections.empty()) {
+        m_condition.notify_all();
+        return nullptr;
+      }
+      entry = m_connections.front();
+      m_connections.pop_front();
+      m_condition.notify_all();
+    }
+    if(isUsable(entry, tick)) {
+      return entry.connection;
+    }
+  }
+}
+
+v_int32 ConnectionReserve::getIdleCount() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return (v_int32) m_connections.size();
+}
+
+}}}
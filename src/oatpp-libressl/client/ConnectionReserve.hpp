@@ -0,0 +1,153 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_client_ConnectionReserve_hpp
+#define oatpp_libressl_client_ConnectionReserve_hpp
+
+#include "oatpp-libressl/Connection.hpp"
+
+#include "oatpp/core/async/Executor.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+namespace oatpp { namespace libressl { namespace client {
+
+/**
+ * Reserve of pre-warmed (connected and handshaked) idle TLS connections to one destination.
+ * Missing connections are created in background on &id:oatpp::async::Executor;.
+ * Idle connections are rotated before they get older than `maxIdleMicros`, so that they are replaced
+ * before the server closes them on its idle timeout.
+ * Failed connects are retried with exponential backoff, so that unavailable upstream is not hammered with reconnects.
+ * See &id:oatpp::libressl::client::ConnectionProvider::setReserve;.
+ */
+class ConnectionReserve : public std::enable_shared_from_this<ConnectionReserve> {
+public:
+  /**
+   * Starter of asynchronous connect.
+   */
+  typedef oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> ConnectionStarter;
+
+  /**
+   * Function creating new asynchronous connect.
+   */
+  typedef std::function<ConnectionStarter()> ConnectFunction;
+private:
+
+  struct Entry {
+    std::shared_ptr<Connection> connection;
+    v_int64 addedAt;
+  };
+
+  class RefillCoroutine;
+  friend RefillCoroutine;
+
+private:
+  std::shared_ptr<oatpp::async::Executor> m_executor;
+  v_int32 m_minIdle;
+  v_int64 m_maxIdleMicros;
+  ConnectFunction m_connect;
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  std::list<Entry> m_connections;
+  v_int32 m_pending;
+  v_int32 m_connecting;
+  v_int32 m_failures;
+  v_int64 m_retryAt;
+  bool m_running;
+  std::thread m_thread;
+private:
+  bool isExpired(const Entry& entry, v_int64 tick);
+  bool isUsable(const Entry& entry, v_int64 tick);
+  void prune(v_int64 tick);
+  void onConnectCalled();
+  void onRefillDone(const std::shared_ptr<Connection>& connection);
+  void run();
+public:
+
+  /**
+   * Constructor.
+   * @param executor - &id:oatpp::async::Executor; to run background connects on.
+   * @param minIdle - number of idle connections to keep ready.
+   * @param maxIdleMicros - rotate idle connection after this time. Should be less than server's idle timeout.
+   * `0` - don't rotate.
+   * @param connect - function creating new asynchronous connect.
+   */
+  ConnectionReserve(const std::shared_ptr<oatpp::async::Executor>& executor,
+                    v_int32 minIdle,
+                    v_int64 maxIdleMicros,
+                    const ConnectFunction& connect);
+
+  /**
+   * Create shared ConnectionReserve.
+   * @param executor - &id:oatpp::async::Executor; to run background connects on.
+   * @param minIdle - number of idle connections to keep ready.
+   * @param maxIdleMicros - rotate idle connection after this time. Should be less than server's idle timeout.
+   * `0` - don't rotate.
+   * @param connect - function creating new asynchronous connect.
+   * @return - `std::shared_ptr` to ConnectionReserve.
+   */
+  static std::shared_ptr<ConnectionReserve> createShared(const std::shared_ptr<oatpp::async::Executor>& executor,
+                                                         v_int32 minIdle,
+                                                         v_int64 maxIdleMicros,
+                                                         const ConnectFunction& connect);
+
+  /**
+   * Virtual destructor.
+   */
+  virtual ~ConnectionReserve();
+
+  /**
+   * Start background refill.
+   */
+  void start();
+
+  /**
+   * Stop background refill and close all idle connections.
+   * Waits for `connect` function calls in progress. After this call `connect` function is never called again,
+   * so it may refer to its owner - ex.: &id:oatpp::libressl::client::ConnectionProvider; stops its reserve on close.
+   */
+  void stop();
+
+  /**
+   * Take ready connection out of the reserve.
+   * @return - `std::shared_ptr` to &id:oatpp::libressl::Connection;. `nullptr` if reserve is empty.
+   */
+  std::shared_ptr<Connection> take();
+
+  /**
+   * Get number of idle connections currently in the reserve.
+   * @return - number of idle connections.
+   */
+  v_int32 getIdleCount();
+
+};
+
+}}}
+
+#endif /* oatpp_libressl_client_ConnectionReserve_hpp */
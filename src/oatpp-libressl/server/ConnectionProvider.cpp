@@ -24,13 +24,18 @@
 
 #include "ConnectionProvider.hpp"
 
+#include "oatpp-libressl/ListenerHandoff.hpp"
+#include "oatpp-libressl/UnixSocketAddress.hpp"
+
 #include "oatpp/core/utils/ConversionUtils.hpp"
 
+#include <cstring>
 #include <fcntl.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 
 #include <openssl/crypto.h>
 
@@ -40,11 +45,17 @@ namespace oatpp { namespace libressl { namespace server {
   
 ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
                                        v_word16 port,
-                                       bool nonBlocking)
+                                       bool nonBlocking,
+                                       const std::shared_ptr<SocketOptions>& socketOptions)
   : m_config(config)
   , m_port(port)
   , m_nonBlocking(nonBlocking)
   , m_closed(false)
+  , m_connectionBytesPerSecond(0)
+  , m_connectionBurst(0)
+  , m_socketOptions(socketOptions ? socketOptions : SocketOptions::createShared())
+  , m_readBufferSize(0)
+  , m_exported(false)
 {
   
   setProperty(PROPERTY_HOST, "localhost");
@@ -60,13 +71,140 @@ ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
   }
   
   m_serverHandle = instantiateServer();
+  instantiateWakePipe();
+  m_tlsServerHandle = instantiateTLSServer();
+}
+
+ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
+                                       const oatpp::String& unixSocketPath,
+                                       bool nonBlocking,
+                                       const std::shared_ptr<SocketOptions>& socketOptions)
+  : m_config(config)
+  , m_port(0)
+  , m_unixPath(unixSocketPath)
+  , m_nonBlocking(nonBlocking)
+  , m_closed(false)
+  , m_connectionBytesPerSecond(0)
+  , m_connectionBurst(0)
+  , m_socketOptions(socketOptions ? socketOptions : SocketOptions::createShared())
+  , m_readBufferSize(0)
+  , m_exported(false)
+{
+
+  setProperty(PROPERTY_HOST, unixSocketPath);
+  setProperty(PROPERTY_PORT, "0");
+
+  auto calback = CRYPTO_get_locking_callback();
+  if(!calback) {
+    OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::ConnectionProvider()]",
+               "WARNING. libressl. CRYPTO_set_locking_callback is NOT set. "
+               "This can cause problems using libressl in multithreaded environment! "
+               "Please call oatpp::libressl::Callbacks::setDefaultCallbacks() or "
+               "consider setting custom locking_callback.");
+  }
+
+  m_serverHandle = instantiateUnixServer();
+  instantiateWakePipe();
+  m_tlsServerHandle = instantiateTLSServer();
+}
+
+ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
+                                       const InheritedListener& listener,
+                                       bool nonBlocking,
+                                       const std::shared_ptr<SocketOptions>& socketOptions)
+  : m_config(config)
+  , m_port(0)
+  , m_nonBlocking(nonBlocking)
+  , m_closed(false)
+  , m_serverHandle(listener.handle)
+  , m_connectionBytesPerSecond(0)
+  , m_connectionBurst(0)
+  , m_socketOptions(socketOptions ? socketOptions : SocketOptions::createShared())
+  , m_readBufferSize(0)
+  , m_exported(false)
+{
+
+  int accepting = 0;
+  socklen_t length = sizeof(accepting);
+  if(getsockopt(m_serverHandle, SOL_SOCKET, SO_ACCEPTCONN, &accepting, &length) != 0 || !accepting) {
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::ConnectionProvider()]: Inherited handle is not a listening socket");
+  }
+
+  struct sockaddr_storage addr;
+  length = sizeof(addr);
+  std::memset(&addr, 0, sizeof(addr));
+  getsockname(m_serverHandle, (struct sockaddr*) &addr, &length);
+
+  if(addr.ss_family == AF_UNIX) {
+    m_unixPath = UnixSocketAddress::getPath((struct sockaddr_un*) &addr, length);
+    setProperty(PROPERTY_HOST, m_unixPath ? m_unixPath : oatpp::String(""));
+    setProperty(PROPERTY_PORT, "0");
+  } else {
+    if(addr.ss_family == AF_INET6) {
+      m_port = ntohs(((struct sockaddr_in6*) &addr)->sin6_port);
+    } else if(addr.ss_family == AF_INET) {
+      m_port = ntohs(((struct sockaddr_in*) &addr)->sin_port);
+    }
+    setProperty(PROPERTY_HOST, "localhost");
+    setProperty(PROPERTY_PORT, oatpp::utils::conversion::int32ToStr(m_port));
+  }
+
+  fcntl(m_serverHandle, F_SETFD, FD_CLOEXEC);
+  fcntl(m_serverHandle, F_SETFL, O_NONBLOCK);
+
+  instantiateWakePipe();
+  m_tlsServerHandle = instantiateTLSServer();
+
+}
+
+ConnectionProvider::ConnectionProvider(const std::shared_ptr<Config>& config,
+                                       const std::shared_ptr<oatpp::network::ServerConnectionProvider>& streamProvider)
+  : m_config(config)
+  , m_port(0)
+  , m_nonBlocking(false)
+  , m_closed(false)
+  , m_serverHandle(-1)
+  , m_streamProvider(streamProvider)
+  , m_connectionBytesPerSecond(0)
+  , m_connectionBurst(0)
+  , m_socketOptions(SocketOptions::createShared())
+  , m_readBufferSize(0)
+  , m_exported(false)
+{
+
+  m_wakeHandles[0] = -1;
+  m_wakeHandles[1] = -1;
+
+  setProperty(PROPERTY_HOST, streamProvider->getProperty(PROPERTY_HOST));
+  setProperty(PROPERTY_PORT, streamProvider->getProperty(PROPERTY_PORT));
+
   m_tlsServerHandle = instantiateTLSServer();
 }
 
 std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
                                                                      v_word16 port,
-                                                                     bool nonBlocking){
-  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, port, nonBlocking));
+                                                                     bool nonBlocking,
+                                                                     const std::shared_ptr<SocketOptions>& socketOptions){
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, port, nonBlocking, socketOptions));
+}
+
+std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
+                                                                     const oatpp::String& unixSocketPath,
+                                                                     bool nonBlocking,
+                                                                     const std::shared_ptr<SocketOptions>& socketOptions){
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, unixSocketPath, nonBlocking, socketOptions));
+}
+
+std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
+                                                                     const InheritedListener& listener,
+                                                                     bool nonBlocking,
+                                                                     const std::shared_ptr<SocketOptions>& socketOptions){
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, listener, nonBlocking, socketOptions));
+}
+
+std::shared_ptr<ConnectionProvider> ConnectionProvider::createShared(const std::shared_ptr<Config>& config,
+                                                                     const std::shared_ptr<oatpp::network::ServerConnectionProvider>& streamProvider){
+  return std::shared_ptr<ConnectionProvider>(new ConnectionProvider(config, streamProvider));
 }
 
 ConnectionProvider::~ConnectionProvider() {
@@ -77,7 +215,6 @@ data::v_io_handle ConnectionProvider::instantiateServer(){
   
   data::v_io_handle serverHandle;
   v_int32 ret;
-  int yes = 1;
   
   struct sockaddr_in6 addr;
   
@@ -91,10 +228,7 @@ data::v_io_handle ConnectionProvider::instantiateServer(){
     return -1;
   }
   
-  ret = setsockopt(serverHandle, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int));
-  if(ret < 0) {
-    OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::instantiateServer()]", "Warning failed to set %s for accepting socket", "SO_REUSEADDR");
-  }
+  m_socketOptions->applyToListener(serverHandle, true);
   
   ret = bind(serverHandle, (struct sockaddr *)&addr, sizeof(addr));
   
@@ -104,18 +238,80 @@ data::v_io_handle ConnectionProvider::instantiateServer(){
     return -1 ;
   }
   
-  ret = listen(serverHandle, 10000);
+  ret = listen(serverHandle, m_socketOptions->backlog);
   if(ret < 0) {
     ::close(serverHandle);
     throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateServer()]: Failed to listen");
     return -1 ;
   }
   
-  fcntl(serverHandle, F_SETFL, 0);//O_NONBLOCK);
+  fcntl(serverHandle, F_SETFL, O_NONBLOCK);
   
   return serverHandle;
   
 }
+
+data::v_io_handle ConnectionProvider::instantiateUnixServer(){
+
+  struct sockaddr_un addr;
+  socklen_t addrLength = UnixSocketAddress::fill(m_unixPath, &addr);
+
+  if(addrLength == 0) {
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateUnixServer()]: Invalid unix socket path");
+  }
+
+  data::v_io_handle serverHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if(serverHandle < 0){
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateUnixServer()]: Can't create socket");
+  }
+
+  if(!UnixSocketAddress::removeStale(m_unixPath)) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateUnixServer()]: "
+                             "Path exists and is not a stale socket - another server is listening or it is not a socket");
+  }
+
+  m_socketOptions->applyToListener(serverHandle, false);
+
+  if(bind(serverHandle, (struct sockaddr *)&addr, addrLength) != 0) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateUnixServer()]: Can't bind to address");
+  }
+
+  if(listen(serverHandle, m_socketOptions->backlog) < 0) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateUnixServer()]: Failed to listen");
+  }
+
+  fcntl(serverHandle, F_SETFL, O_NONBLOCK);
+
+  return serverHandle;
+
+}
+
+void ConnectionProvider::instantiateWakePipe() {
+  if(pipe(m_wakeHandles) != 0) {
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::instantiateWakePipe()]: Can't create pipe");
+  }
+  fcntl(m_wakeHandles[0], F_SETFD, FD_CLOEXEC);
+  fcntl(m_wakeHandles[1], F_SETFD, FD_CLOEXEC);
+}
+
+void ConnectionProvider::wakeAccept() {
+  /* pipe is never drained - it stays readable and getConnection() doesn't poll the listener anymore */
+  char signal = 1;
+  if(::write(m_wakeHandles[1], &signal, 1) != 1) {
+    OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::wakeAccept()]", "Error: %d", errno);
+  }
+}
+
+void ConnectionProvider::waitClosed() {
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  while(!m_closed) {
+    m_stateCondition.wait(lock);
+  }
+}
   
 Connection::TLSHandle ConnectionProvider::instantiateTLSServer() {
   
@@ -135,26 +331,158 @@ Connection::TLSHandle ConnectionProvider::instantiateTLSServer() {
 }
 
 void ConnectionProvider::close() {
-  if(!m_closed) {
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if(m_closed) {
+      return;
+    }
     m_closed = true;
-    tls_close(m_tlsServerHandle);
-    tls_free(m_tlsServerHandle);
+  }
+  m_stateCondition.notify_all();
+  tls_close(m_tlsServerHandle);
+  tls_free(m_tlsServerHandle);
+  if(m_streamProvider) {
+    m_streamProvider->close();
+  } else {
+    wakeAccept();
     ::close(m_serverHandle);
+    ::close(m_wakeHandles[0]);
+    ::close(m_wakeHandles[1]);
+  }
+  /* after export the socket file belongs to successor */
+  if(m_unixPath && !m_exported && !UnixSocketAddress::isAbstract(m_unixPath)) {
+    ::unlink(m_unixPath->c_str());
+  }
+}
+
+bool ConnectionProvider::exportListener(const oatpp::String& handoffPath, v_int64 timeoutMicros) {
+  if(m_streamProvider) {
+    throw std::runtime_error("[oatpp::libressl::server::ConnectionProvider::exportListener()]: Provider has no listen socket");
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if(m_closed) {
+      return false;
+    }
+  }
+  if(ListenerHandoff::send(handoffPath, m_serverHandle, timeoutMicros)) {
+    m_exported = true;
+    /* listener is successor's now - stop accepting connections here */
+    wakeAccept();
+  }
+  return m_exported;
+}
+
+void ConnectionProvider::setWriteRateLimit(v_int64 connectionBytesPerSecond, v_int64 connectionBurst,
+                                           const std::shared_ptr<RateLimiter>& sharedLimiter)
+{
+  m_connectionBytesPerSecond = connectionBytesPerSecond;
+  m_connectionBurst = connectionBurst;
+  m_sharedWriteLimiter = sharedLimiter;
+}
+
+void ConnectionProvider::setReadBufferSize(v_int32 size) {
+  m_readBufferSize = size;
+}
+
+void ConnectionProvider::setupConnection(const std::shared_ptr<Connection>& connection, v_int64 acceptedAt) {
+  (void) acceptedAt; /* unused unless built with trace */
+  OATPP_LIBRESSL_TRACE_EVENT_AT(connection->getTraceSpan(), ACCEPT, acceptedAt);
+  connection->setCertVerifier(m_config->getClientCertVerifier());
+  connection->setSessionKeys(m_config->getSessionKeys());
+  if(m_readBufferSize > 0) {
+    connection->setReadBuffer(m_readBufferSize);
+  }
+  if(m_connectionBytesPerSecond > 0 || m_sharedWriteLimiter) {
+    std::shared_ptr<RateLimiter> limiter;
+    if(m_connectionBytesPerSecond > 0) {
+      limiter = RateLimiter::createShared(m_connectionBytesPerSecond, m_connectionBurst);
+    }
+    connection->setWriteLimiters(limiter, m_sharedWriteLimiter);
+  }
+}
+
+void ConnectionProvider::syncSessionStore() {
+  auto store = m_config->getSessionStore();
+  if(store) {
+    store->sync(*m_config->getSessionKeys());
+  }
+}
+
+std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getStreamConnection() {
+
+  auto stream = m_streamProvider->getConnection();
+  if(!stream) {
+    return nullptr;
+  }
+
+  v_int64 acceptedAt = OATPP_LIBRESSL_TRACE_TICK();
+
+  Connection::TLSHandle tlsHandle;
+
+  syncSessionStore();
+
+  if(tls_accept_cbs(m_tlsServerHandle, &tlsHandle, Connection::readCallback, Connection::writeCallback, stream.get()) < 0) {
+    OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::getStreamConnection()]", "Error on call to 'tls_accept_cbs'. %s", tls_error(m_tlsServerHandle));
+    return nullptr;
   }
+
+  auto connection = Connection::createShared(tlsHandle, stream);
+  setupConnection(connection, acceptedAt);
+  return connection;
+
 }
 
 std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getConnection(){
-  
-  data::v_io_handle handle = accept(m_serverHandle, nullptr, nullptr);
-  
-  if (handle < 0) {
-    v_int32 error = errno;
-    if(error == EAGAIN || error == EWOULDBLOCK){
+
+  if(m_streamProvider) {
+    return getStreamConnection();
+  }
+
+  struct pollfd fds[2];
+  fds[0].fd = m_serverHandle;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_wakeHandles[0];
+  fds[1].events = POLLIN;
+
+  data::v_io_handle handle = -1;
+  v_int64 acceptedAt = 0;
+
+  while(handle < 0) {
+
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+
+    if(::poll(fds, 2, -1) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::getConnection()]", "Error on call to 'poll': %d", errno);
+      return nullptr;
+    }
+
+    /* provider is closed or listener is exported - don't return right away, server loop would spin */
+    if(fds[1].revents != 0) {
+      waitClosed();
       return nullptr;
-    } else {
-      OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::getConnection()]", "Error: %d", error);
+    }
+
+    if((fds[0].revents & POLLIN) == 0) {
       return nullptr;
     }
+
+    handle = accept(m_serverHandle, nullptr, nullptr);
+    acceptedAt = OATPP_LIBRESSL_TRACE_TICK();
+
+    if (handle < 0) {
+      v_int32 error = errno;
+      /* connection was taken by other thread - poll again */
+      if(error != EAGAIN && error != EWOULDBLOCK && error != EINTR && error != ECONNABORTED) {
+        OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::getConnection()]", "Error: %d", error);
+        return nullptr;
+      }
+    }
+
   }
   
 #ifdef SO_NOSIGPIPE
@@ -171,15 +499,22 @@ std::shared_ptr<oatpp::data::stream::IOStream> ConnectionProvider::getConnection
   }
   
   fcntl(handle, F_SETFL, flags);
+
+  m_socketOptions->applyToAccepted(handle, !m_unixPath);
   
   Connection::TLSHandle tlsHandle;
+
+  syncSessionStore();
   
   if(tls_accept_socket(m_tlsServerHandle, &tlsHandle, handle) < 0) {
     OATPP_LOGD("[oatpp::libressl::server::ConnectionProvider::getConnection()]", "Error on call to 'tls_accept_socket'");
     ::close(handle);
+    return nullptr;
   }
   
-  return Connection::createShared(tlsHandle, handle);
+  auto connection = Connection::createShared(tlsHandle, handle);
+  setupConnection(connection, acceptedAt);
+  return connection;
   
 }
   
@@ -27,26 +27,64 @@
 
 #include "oatpp-libressl/Config.hpp"
 #include "oatpp-libressl/Connection.hpp"
+#include "oatpp-libressl/SocketOptions.hpp"
 
 #include "oatpp/network/ConnectionProvider.hpp"
 
+#include <condition_variable>
+#include <mutex>
+
 namespace oatpp { namespace libressl { namespace server {
 
 /**
  * Libressl server connection provider.
  * Extends &id:oatpp::base::Countable;, &id:oatpp::network::ServerConnectionProvider;.
+ * Accepts TLS connections either on its own TCP or unix domain socket, or over streams provided by
+ * other &id:oatpp::network::ServerConnectionProvider; (in-memory pipes, unix sockets, TLS-in-TLS, etc.).
  */
 class ConnectionProvider : public oatpp::base::Countable, public oatpp::network::ServerConnectionProvider {
+public:
+
+  /**
+   * Listen socket inherited from predecessor process - see &id:oatpp::libressl::ListenerHandoff::receive;.
+   */
+  struct InheritedListener {
+
+    /**
+     * Listen socket handle.
+     */
+    data::v_io_handle handle;
+
+  };
+
 private:
   std::shared_ptr<Config> m_config;
   v_word16 m_port;
+  oatpp::String m_unixPath;
   bool m_nonBlocking;
   bool m_closed;
   data::v_io_handle m_serverHandle;
   Connection::TLSHandle m_tlsServerHandle;
+  std::shared_ptr<oatpp::network::ServerConnectionProvider> m_streamProvider;
+  v_int64 m_connectionBytesPerSecond;
+  v_int64 m_connectionBurst;
+  std::shared_ptr<RateLimiter> m_sharedWriteLimiter;
+  std::shared_ptr<SocketOptions> m_socketOptions;
+  v_int32 m_readBufferSize;
+  bool m_exported;
+  data::v_io_handle m_wakeHandles[2];
+  std::mutex m_stateMutex;
+  std::condition_variable m_stateCondition;
 private:
   data::v_io_handle instantiateServer();
+  data::v_io_handle instantiateUnixServer();
+  void instantiateWakePipe();
+  void wakeAccept();
+  void waitClosed();
   Connection::TLSHandle instantiateTLSServer();
+  std::shared_ptr<IOStream> getStreamConnection();
+  void syncSessionStore();
+  void setupConnection(const std::shared_ptr<Connection>& connection, v_int64 acceptedAt);
 public:
   /**
    * Constructor.
@@ -54,8 +92,45 @@ public:
    * @param port - port to listen on.
    * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
    * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
    */
-  ConnectionProvider(const std::shared_ptr<Config>& config, v_word16 port, bool nonBlocking = false);
+  ConnectionProvider(const std::shared_ptr<Config>& config, v_word16 port, bool nonBlocking = false,
+                     const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Constructor. Listen on unix domain socket.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param unixSocketPath - path of the socket. Start path with '@' to use Linux abstract namespace.
+   * Stale socket file at this path is removed - see &id:oatpp::libressl::UnixSocketAddress::removeStale;.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
+   * @throws - `std::runtime_error` if path is taken by a file which is not a socket or by a listening socket.
+   */
+  ConnectionProvider(const std::shared_ptr<Config>& config, const oatpp::String& unixSocketPath, bool nonBlocking = false,
+                     const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Constructor. Adopt listen socket - TCP or unix domain - inherited from predecessor process.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param listener - &l:ConnectionProvider::InheritedListener;. Provider takes ownership of the handle.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for accepted sockets. `nullptr` - defaults.
+   * Listener options were applied by predecessor.
+   * @throws - `std::runtime_error` if handle is not a listening socket.
+   */
+  ConnectionProvider(const std::shared_ptr<Config>& config, const InheritedListener& listener, bool nonBlocking = false,
+                     const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Constructor.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param streamProvider - provider of underlying transport streams. TLS is run over these streams via libtls callback I/O.
+   * Blocking mode of connections is defined by the streams.
+   */
+  ConnectionProvider(const std::shared_ptr<Config>& config,
+                     const std::shared_ptr<oatpp::network::ServerConnectionProvider>& streamProvider);
 public:
 
   /**
@@ -64,11 +139,50 @@ public:
    * @param port - port to listen on.
    * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
    * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
    * @return `std::shared_ptr` to ConnectionProvider.
    */
   static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
                                                           v_word16 port,
-                                                          bool nonBlocking = false);
+                                                          bool nonBlocking = false,
+                                                          const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Create shared ConnectionProvider listening on unix domain socket.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param unixSocketPath - path of the socket. Start path with '@' to use Linux abstract namespace.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
+   * @return `std::shared_ptr` to ConnectionProvider.
+   */
+  static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
+                                                          const oatpp::String& unixSocketPath,
+                                                          bool nonBlocking = false,
+                                                          const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Create shared ConnectionProvider adopting listen socket inherited from predecessor process.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param listener - &l:ConnectionProvider::InheritedListener;. Provider takes ownership of the handle.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for accepted sockets. `nullptr` - defaults.
+   * @return `std::shared_ptr` to ConnectionProvider.
+   */
+  static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
+                                                          const InheritedListener& listener,
+                                                          bool nonBlocking = false,
+                                                          const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Create shared ConnectionProvider running TLS over streams of other provider.
+   * @param config - &id:oatpp::libressl::Config;.
+   * @param streamProvider - provider of underlying transport streams.
+   * @return `std::shared_ptr` to ConnectionProvider.
+   */
+  static std::shared_ptr<ConnectionProvider> createShared(const std::shared_ptr<Config>& config,
+                                                          const std::shared_ptr<oatpp::network::ServerConnectionProvider>& streamProvider);
 
   /**
    * Virtual destructor.
@@ -76,13 +190,64 @@ public:
   ~ConnectionProvider();
 
   /**
-   * Close all handles.
+   * Limit write rate of accepted connections - ex.: so that bulk downloads don't starve small responses.
+   * Applies to connections accepted after the call. See &id:oatpp::libressl::Connection::setWriteLimiters;.
+   * @param connectionBytesPerSecond - write rate of each connection. `0` - no per-connection limit.
+   * @param connectionBurst - max bytes each connection writes at once.
+   * @param sharedLimiter - &id:oatpp::libressl::RateLimiter; shared by all connections of this provider. May be `nullptr`.
+   */
+  void setWriteRateLimit(v_int64 connectionBytesPerSecond, v_int64 connectionBurst,
+                         const std::shared_ptr<RateLimiter>& sharedLimiter = nullptr);
+
+  /**
+   * Get &id:oatpp::libressl::RateLimiter; shared by all connections of this provider.
+   * @return - `std::shared_ptr` to RateLimiter. `nullptr` if not set.
+   */
+  std::shared_ptr<RateLimiter> getSharedWriteLimiter() {
+    return m_sharedWriteLimiter;
+  }
+
+  /**
+   * Enable buffered input mode for accepted connections - reduces per-read overhead for parsers which read
+   * a few bytes at a time. Applies to connections accepted after the call.
+   * See &id:oatpp::libressl::Connection::setReadBuffer;.
+   * @param size - read buffer size of each connection. `0` - disabled (default).
+   */
+  void setReadBufferSize(v_int32 size);
+
+  /**
+   * Pass listen socket to successor process for zero-downtime restart - see &id:oatpp::libressl::ListenerHandoff;.
+   * Blocks until successor took the socket. Once exported, &l:ConnectionProvider::getConnection (); stops accepting,
+   * so connections are not taken away from successor - it blocks until the provider is closed and returns `nullptr`.
+   * Then stop the server and close this provider - closing doesn't affect successor's listener,
+   * and connections already accepted here are served until they drain.
+   * Unix socket file is not removed on close after export.
+   * @param handoffPath - unix socket path successor connects to. Start path with '@' to use Linux abstract namespace.
+   * @param timeoutMicros - how long to wait for successor.
+   * @return - `true` if successor took the socket.
+   * @throws - `std::runtime_error` if provider runs over stream provider or `handoffPath` can't be listened on.
+   */
+  bool exportListener(const oatpp::String& handoffPath, v_int64 timeoutMicros);
+
+  /**
+   * Get listen socket.
+   * @return - &id:oatpp::data::v_io_handle;. `-1` if provider runs over stream provider.
+   */
+  data::v_io_handle getListenerHandle() {
+    return m_serverHandle;
+  }
+
+  /**
+   * Close all handles. Blocked &l:ConnectionProvider::getConnection (); returns `nullptr`.
    */
   void close() override;
 
   /**
    * Get incoming connection.
-   * @return &id:oatpp::data::stream::IOStream;.
+   * Listen socket is non-blocking - several threads may call this method, connection taken by other thread
+   * doesn't block the caller in `accept()`.
+   * @return &id:oatpp::data::stream::IOStream;. `nullptr` if provider is closed. After
+   * &l:ConnectionProvider::exportListener (); blocks until provider is closed.
    */
   std::shared_ptr<IOStream> getConnection() override;
 
@@ -0,0 +1,469 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Ring.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <errno.h>
+#include <thread>
+
+#if defined(OATPP_LIBRESSL_IO_URING)
+  #include <linux/io_uring.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace oatpp { namespace libressl { namespace uring {
+
+Ring::Operation::Operation()
+  : m_pending(false)
+  , m_done(false)
+  , m_result(0)
+{}
+
+v_int32 Ring::Operation::takeResult() {
+  v_int32 result = m_result;
+  m_done.store(false, std::memory_order_release);
+  return result;
+}
+
+Ring::Ring(v_int32 entries, v_int32 bufferCount, v_int32 bufferSize, v_int32 batchSize, v_int64 maxDelayMicros)
+  : m_fd(-1)
+  , m_sqRing(nullptr)
+  , m_sqRingSize(0)
+  , m_cqRing(nullptr)
+  , m_cqRingSize(0)
+  , m_sqes(nullptr)
+  , m_sqesSize(0)
+  , m_sqHead(nullptr)
+  , m_sqTail(nullptr)
+  , m_sqArray(nullptr)
+  , m_sqMask(0)
+  , m_sqEntries(0)
+  , m_cqHead(nullptr)
+  , m_cqTail(nullptr)
+  , m_cqes(nullptr)
+  , m_cqMask(0)
+  , m_cqEntries(0)
+  , m_waiting(false)
+  , m_queued(0)
+  , m_firstQueuedAt(0)
+  , m_inFlight(0)
+  , m_batchSize(batchSize > 0 ? batchSize : 1)
+  , m_maxDelayMicros(maxDelayMicros)
+  , m_bufferCount(0)
+  , m_bufferSize(bufferSize)
+  , m_enterCalls(0)
+  , m_submitted(0)
+{
+  if(setup(entries)) {
+    registerBuffers(bufferCount, bufferSize);
+  } else {
+    OATPP_LOGD("[oatpp::libressl::uring::Ring::Ring()]", "io_uring is not available. Using recv()/send().");
+  }
+}
+
+std::shared_ptr<Ring> Ring::createShared(v_int32 entries, v_int32 bufferCount, v_int32 bufferSize,
+                                         v_int32 batchSize, v_int64 maxDelayMicros)
+{
+  return std::make_shared<Ring>(entries, bufferCount, bufferSize, batchSize, maxDelayMicros);
+}
+
+Ring::~Ring() {
+  destroy();
+}
+
+#if defined(OATPP_LIBRESSL_IO_URING)
+
+namespace {
+
+  /* back off of Ring::wait() when io_uring_enter() fails without waiting */
+  const v_int64 WAIT_RETRY_MICROS = 50;
+
+}
+
+bool Ring::setup(v_int32 entries) {
+
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  int fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+  if(fd < 0) {
+    return false;
+  }
+
+  m_fd = fd;
+
+  m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+  if(params.features & IORING_FEAT_SINGLE_MMAP) {
+    if(m_cqRingSize > m_sqRingSize) {
+      m_sqRingSize = m_cqRingSize;
+    }
+    m_cqRingSize = m_sqRingSize;
+  }
+
+  m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if(m_sqRing == MAP_FAILED) {
+    m_sqRing = nullptr;
+    destroy();
+    return false;
+  }
+
+  if(params.features & IORING_FEAT_SINGLE_MMAP) {
+    m_cqRing = m_sqRing;
+  } else {
+    m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if(m_cqRing == MAP_FAILED) {
+      m_cqRing = nullptr;
+      destroy();
+      return false;
+    }
+  }
+
+  m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if(m_sqes == MAP_FAILED) {
+    m_sqes = nullptr;
+    destroy();
+    return false;
+  }
+
+  v_char8* sq = (v_char8*) m_sqRing;
+  m_sqHead = (unsigned*) (sq + params.sq_off.head);
+  m_sqTail = (unsigned*) (sq + params.sq_off.tail);
+  m_sqArray = (unsigned*) (sq + params.sq_off.array);
+  m_sqMask = *(unsigned*) (sq + params.sq_off.ring_mask);
+  m_sqEntries = params.sq_entries;
+
+  v_char8* cq = (v_char8*) m_cqRing;
+  m_cqHead = (unsigned*) (cq + params.cq_off.head);
+  m_cqTail = (unsigned*) (cq + params.cq_off.tail);
+  m_cqes = cq + params.cq_off.cqes;
+  m_cqMask = *(unsigned*) (cq + params.cq_off.ring_mask);
+  m_cqEntries = params.cq_entries;
+
+  return true;
+
+}
+
+void Ring::registerBuffers(v_int32 bufferCount, v_int32 bufferSize) {
+
+  if(bufferCount <= 0 || bufferSize <= 0) {
+    return;
+  }
+
+  m_buffers.reset(new v_char8[(size_t) bufferCount * bufferSize]);
+
+  std::vector<struct iovec> iovecs(bufferCount);
+  for(v_int32 i = 0; i < bufferCount; i ++) {
+    iovecs[i].iov_base = getBuffer(i);
+    iovecs[i].iov_len = bufferSize;
+  }
+
+  /* fails if exceeds RLIMIT_MEMLOCK. Then sockets use their own buffers */
+  if(syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, iovecs.data(), bufferCount) < 0) {
+    OATPP_LOGD("[oatpp::libressl::uring::Ring::registerBuffers()]", "Can't register buffers. errno=%d", errno);
+    m_buffers.reset();
+    return;
+  }
+
+  m_bufferCount = bufferCount;
+  m_freeBuffers.reserve(bufferCount);
+  for(v_int32 i = bufferCount - 1; i >= 0; i --) {
+    m_freeBuffers.push_back(i);
+  }
+
+}
+
+void Ring::destroy() {
+  if(m_sqes) {
+    munmap(m_sqes, m_sqesSize);
+    m_sqes = nullptr;
+  }
+  if(m_cqRing && m_cqRing != m_sqRing) {
+    munmap(m_cqRing, m_cqRingSize);
+  }
+  m_cqRing = nullptr;
+  if(m_sqRing) {
+    munmap(m_sqRing, m_sqRingSize);
+    m_sqRing = nullptr;
+  }
+  if(m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+int Ring::enter(unsigned toSubmit, unsigned minComplete) {
+  m_enterCalls ++;
+  return (int) syscall(__NR_io_uring_enter, m_fd, toSubmit, minComplete,
+                       minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+}
+
+void Ring::reapLocked() {
+
+  unsigned head = *m_cqHead;
+  unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+  while(head != tail) {
+    struct io_uring_cqe* cqe = &((struct io_uring_cqe*) m_cqes)[head & m_cqMask];
+    Operation* operation = (Operation*) (uintptr_t) cqe->user_data;
+    operation->m_result = cqe->res;
+    operation->m_pending.store(false, std::memory_order_relaxed);
+    operation->m_done.store(true, std::memory_order_release);
+    m_inFlight --;
+    head ++;
+  }
+
+  __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+}
+
+void Ring::submitLocked() {
+
+  unsigned queued = *m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+  if(queued == 0) {
+    m_queued = 0;
+    return;
+  }
+
+  int res;
+  while((res = enter(queued, 0)) < 0 && errno == EINTR) {}
+  if(res > 0) {
+    m_submitted += res;
+  }
+
+  /* partial submit, EBUSY, EAGAIN - entries not consumed by the kernel stay queued and are submitted next time */
+  m_queued = (v_int32) (*m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE));
+
+}
+
+bool Ring::submit(Operation* operation, OperationType type, data::v_io_handle handle, void* data, v_int32 size, v_int32 bufferIndex) {
+
+  if(m_fd < 0) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  /* completion queue must never overflow - it is twice the size of submission queue */
+  if(m_inFlight >= (v_int32) m_cqEntries) {
+    reapLocked();
+    if(m_inFlight >= (v_int32) m_cqEntries) {
+      return false;
+    }
+  }
+
+  unsigned tail = *m_sqTail;
+  if(tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+    submitLocked();
+    if(tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+      return false;
+    }
+  }
+
+  unsigned index = tail & m_sqMask;
+  struct io_uring_sqe* sqe = &((struct io_uring_sqe*) m_sqes)[index];
+  std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+  sqe->fd = handle;
+  sqe->off = 0;
+  sqe->user_data = (uintptr_t) operation;
+
+  if(bufferIndex >= 0) {
+    sqe->opcode = type == READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+    sqe->addr = (uintptr_t) data;
+    sqe->len = size;
+    sqe->buf_index = (v_word16) bufferIndex;
+  } else {
+    operation->m_iovec.iov_base = data;
+    operation->m_iovec.iov_len = size;
+    sqe->opcode = type == READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->addr = (uintptr_t) &operation->m_iovec;
+    sqe->len = 1;
+  }
+
+  operation->m_done.store(false, std::memory_order_relaxed);
+  operation->m_pending.store(true, std::memory_order_relaxed);
+
+  m_sqArray[index] = index;
+  __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+  if(m_queued == 0) {
+    m_firstQueuedAt = oatpp::base::Environment::getMicroTickCount();
+  }
+  m_queued ++;
+  m_inFlight ++;
+
+  return true;
+
+}
+
+void Ring::poll() {
+  if(m_fd < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_lock);
+  reapLocked();
+  if(m_queued >= m_batchSize ||
+     (m_queued > 0 && oatpp::base::Environment::getMicroTickCount() - m_firstQueuedAt >= m_maxDelayMicros))
+  {
+    submitLocked();
+  }
+}
+
+void Ring::flush() {
+  if(m_fd < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_lock);
+  reapLocked();
+  submitLocked();
+}
+
+void Ring::wait(Operation* operation) {
+
+  if(m_fd < 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_lock);
+
+  /* one thread waits in the kernel, others wait for it to reap their completions */
+  while(operation->isPending()) {
+
+    reapLocked();
+    if(!operation->isPending()) {
+      break;
+    }
+
+    if(m_waiting) {
+      /* waiting thread may be in the kernel already - submit own operation */
+      submitLocked();
+      m_condition.wait(lock);
+      continue;
+    }
+
+    /* submit queued operations and wait for a completion in one call.
+     * Entries queued by other threads meanwhile are submitted by them - see above */
+    unsigned queued = *m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    m_waiting = true;
+    lock.unlock();
+    int res = enter(queued, 1);
+    int error = errno;
+    lock.lock();
+    m_waiting = false;
+    if(res > 0) {
+      m_submitted += res;
+    }
+    m_queued = (v_int32) (*m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE));
+    reapLocked();
+    m_condition.notify_all();
+
+    if(res < 0 && error != EINTR) {
+      /* EAGAIN, EBUSY - kernel neither took entries nor waited. Give it time to free resources */
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::microseconds(WAIT_RETRY_MICROS));
+      lock.lock();
+    }
+
+  }
+
+}
+
+#else
+
+bool Ring::setup(v_int32 entries) {
+  (void) entries;
+  return false;
+}
+
+void Ring::registerBuffers(v_int32 bufferCount, v_int32 bufferSize) {
+  (void) bufferCount;
+  (void) bufferSize;
+}
+
+void Ring::destroy() {
+}
+
+int Ring::enter(unsigned toSubmit, unsigned minComplete) {
+  (void) toSubmit;
+  (void) minComplete;
+  return -1;
+}
+
+void Ring::reapLocked() {
+}
+
+void Ring::submitLocked() {
+}
+
+bool Ring::submit(Operation* operation, OperationType type, data::v_io_handle handle, void* data, v_int32 size, v_int32 bufferIndex) {
+  (void) operation;
+  (void) type;
+  (void) handle;
+  (void) data;
+  (void) size;
+  (void) bufferIndex;
+  return false;
+}
+
+void Ring::poll() {
+}
+
+void Ring::flush() {
+}
+
+void Ring::wait(Operation* operation) {
+  (void) operation;
+}
+
+#endif
+
+v_int32 Ring::acquireBuffer() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if(m_freeBuffers.empty()) {
+    return -1;
+  }
+  v_int32 index = m_freeBuffers.back();
+  m_freeBuffers.pop_back();
+  return index;
+}
+
+void Ring::releaseBuffer(v_int32 index) {
+  if(index >= 0) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_freeBuffers.push_back(index);
+  }
+}
+
+}}}
@@ -0,0 +1,261 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_uring_Ring_hpp
+#define oatpp_libressl_uring_Ring_hpp
+
+#include "oatpp/core/data/IODefinitions.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace oatpp { namespace libressl { namespace uring {
+
+/**
+ * Linux io_uring shared by many &id:oatpp::libressl::uring::Socket;.
+ * Submissions of all sockets are queued and passed to the kernel in batches - one `io_uring_enter()`
+ * for many reads and writes. Completions are reaped from shared memory without syscalls.
+ * Holds a pool of buffers registered with the kernel, so that fixed-buffer reads and writes avoid
+ * page pinning on each operation.<br>
+ * Compiled in with `-DOATPP_LIBRESSL_IO_URING=ON`. Otherwise, or if kernel doesn't allow io_uring
+ * (old kernel, seccomp), &l:Ring::isAvailable (); returns `false` and sockets fall back to plain `recv()`/`send()`.
+ */
+class Ring {
+public:
+
+  /**
+   * Type of operation.
+   */
+  enum OperationType : v_int32 {
+    READ = 0,
+    WRITE = 1
+  };
+
+  /**
+   * Operation submitted to the ring. Owned by submitter and must stay alive until it is completed.
+   */
+  class Operation {
+    friend Ring;
+  private:
+    std::atomic<bool> m_pending;
+    std::atomic<bool> m_done;
+    v_int32 m_result;
+    struct iovec m_iovec;
+  public:
+
+    Operation();
+
+    /**
+     * Operation is submitted and not completed yet.
+     * @return - `true` if pending.
+     */
+    bool isPending() {
+      return m_pending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Operation is completed and its result is not taken yet.
+     * @return - `true` if done.
+     */
+    bool isDone() {
+      return m_done.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Take result and make operation ready for reuse.
+     * @return - amount of bytes transferred, or negative `errno`.
+     */
+    v_int32 takeResult();
+
+  };
+
+private:
+  int m_fd;
+  void* m_sqRing;
+  size_t m_sqRingSize;
+  void* m_cqRing;
+  size_t m_cqRingSize;
+  void* m_sqes;
+  size_t m_sqesSize;
+  unsigned* m_sqHead;
+  unsigned* m_sqTail;
+  unsigned* m_sqArray;
+  unsigned m_sqMask;
+  unsigned m_sqEntries;
+  unsigned* m_cqHead;
+  unsigned* m_cqTail;
+  void* m_cqes;
+  unsigned m_cqMask;
+  unsigned m_cqEntries;
+private:
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  bool m_waiting;
+  v_int32 m_queued;
+  v_int64 m_firstQueuedAt;
+  v_int32 m_inFlight;
+  v_int32 m_batchSize;
+  v_int64 m_maxDelayMicros;
+private:
+  std::unique_ptr<v_char8[]> m_buffers;
+  v_int32 m_bufferCount;
+  v_int32 m_bufferSize;
+  std::vector<v_int32> m_freeBuffers;
+private:
+  std::atomic<v_int64> m_enterCalls;
+  std::atomic<v_int64> m_submitted;
+private:
+  bool setup(v_int32 entries);
+  void registerBuffers(v_int32 bufferCount, v_int32 bufferSize);
+  void destroy();
+  void reapLocked();
+  void submitLocked();
+  int enter(unsigned toSubmit, unsigned minComplete);
+public:
+
+  /**
+   * Constructor.
+   * @param entries - size of submission queue. Max number of operations in flight is twice this size.
+   * @param bufferCount - number of registered buffers. Each socket takes two - for read and for write.
+   * Sockets which get no registered buffers use their own buffers.
+   * @param bufferSize - size of each registered buffer. `16384` + TLS record overhead fits one TLS record.
+   * @param batchSize - submit queued operations to the kernel when this many are queued.
+   * @param maxDelayMicros - or when the oldest queued operation waits this long.
+   */
+  Ring(v_int32 entries, v_int32 bufferCount, v_int32 bufferSize, v_int32 batchSize, v_int64 maxDelayMicros);
+
+  /**
+   * Create shared Ring.
+   * @param entries - size of submission queue.
+   * @param bufferCount - number of registered buffers.
+   * @param bufferSize - size of each registered buffer.
+   * @param batchSize - submit queued operations to the kernel when this many are queued.
+   * @param maxDelayMicros - or when the oldest queued operation waits this long.
+   * @return - `std::shared_ptr` to Ring.
+   */
+  static std::shared_ptr<Ring> createShared(v_int32 entries = 1024,
+                                            v_int32 bufferCount = 512,
+                                            v_int32 bufferSize = 17 * 1024,
+                                            v_int32 batchSize = 32,
+                                            v_int64 maxDelayMicros = 50);
+
+  /**
+   * Virtual destructor. All operations must be completed.
+   */
+  ~Ring();
+
+  /**
+   * Check if io_uring is set up. If not - sockets fall back to plain `recv()`/`send()`.
+   * @return - `true` if available.
+   */
+  bool isAvailable() {
+    return m_fd >= 0;
+  }
+
+  /**
+   * Take registered buffer from the pool.
+   * @return - buffer index. `-1` if pool is empty.
+   */
+  v_int32 acquireBuffer();
+
+  /**
+   * Return registered buffer to the pool.
+   * @param index - buffer index.
+   */
+  void releaseBuffer(v_int32 index);
+
+  /**
+   * Get registered buffer.
+   * @param index - buffer index.
+   * @return - pointer to buffer memory.
+   */
+  v_char8* getBuffer(v_int32 index) {
+    return &m_buffers[(size_t) index * m_bufferSize];
+  }
+
+  /**
+   * Get size of registered buffers.
+   * @return - size in bytes.
+   */
+  v_int32 getBufferSize() {
+    return m_bufferSize;
+  }
+
+  /**
+   * Queue operation. It is passed to the kernel with the next batch - see &l:Ring::poll ();, &l:Ring::flush ();.
+   * @param operation - &l:Ring::Operation;.
+   * @param type - &l:Ring::OperationType;.
+   * @param handle - file descriptor.
+   * @param data - buffer. Must be registered buffer if `bufferIndex >= 0`.
+   * @param size - buffer size.
+   * @param bufferIndex - index of registered buffer. `-1` for not registered buffer.
+   * @return - `false` if ring is full or not available.
+   */
+  bool submit(Operation* operation, OperationType type, data::v_io_handle handle, void* data, v_int32 size, v_int32 bufferIndex);
+
+  /**
+   * Reap completions and submit queued operations if batch is full or the batch delay is exceeded.
+   * Doesn't block. Call when operation is not done yet, before yielding.
+   */
+  void poll();
+
+  /**
+   * Reap completions and submit all queued operations now.
+   */
+  void flush();
+
+  /**
+   * Block until operation is completed.
+   * @param operation - &l:Ring::Operation;.
+   */
+  void wait(Operation* operation);
+
+  /**
+   * Get number of `io_uring_enter()` calls.
+   * @return - count.
+   */
+  v_int64 getEnterCalls() {
+    return m_enterCalls.load();
+  }
+
+  /**
+   * Get number of submitted operations.
+   * @return - count.
+   */
+  v_int64 getSubmittedCount() {
+    return m_submitted.load();
+  }
+
+};
+
+}}}
+
+#endif /* oatpp_libressl_uring_Ring_hpp */
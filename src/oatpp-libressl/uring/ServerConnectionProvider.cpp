@@ -0,0 +1,129 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ServerConnectionProvider.hpp"
+
+#include "oatpp/core/utils/ConversionUtils.hpp"
+
+#include <cstring>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace oatpp { namespace libressl { namespace uring {
+
+ServerConnectionProvider::ServerConnectionProvider(const std::shared_ptr<Ring>& ring,
+                                                   v_word16 port,
+                                                   bool nonBlocking,
+                                                   const std::shared_ptr<SocketOptions>& socketOptions)
+  : m_ring(ring)
+  , m_port(port)
+  , m_nonBlocking(nonBlocking)
+  , m_closed(false)
+  , m_socketOptions(socketOptions ? socketOptions : SocketOptions::createShared())
+{
+  setProperty(PROPERTY_HOST, "localhost");
+  setProperty(PROPERTY_PORT, oatpp::utils::conversion::int32ToStr(port));
+  m_serverHandle = instantiateServer();
+}
+
+std::shared_ptr<ServerConnectionProvider> ServerConnectionProvider::createShared(const std::shared_ptr<Ring>& ring,
+                                                                                 v_word16 port,
+                                                                                 bool nonBlocking,
+                                                                                 const std::shared_ptr<SocketOptions>& socketOptions)
+{
+  return std::make_shared<ServerConnectionProvider>(ring, port, nonBlocking, socketOptions);
+}
+
+ServerConnectionProvider::~ServerConnectionProvider() {
+  close();
+}
+
+data::v_io_handle ServerConnectionProvider::instantiateServer() {
+
+  struct sockaddr_in6 addr;
+  std::memset(&addr, 0, sizeof(addr));
+
+  addr.sin6_family = AF_INET6;
+  addr.sin6_port = htons(m_port);
+  addr.sin6_addr = in6addr_any;
+
+  data::v_io_handle serverHandle = socket(AF_INET6, SOCK_STREAM, 0);
+
+  if(serverHandle < 0) {
+    throw std::runtime_error("[oatpp::libressl::uring::ServerConnectionProvider::instantiateServer()]: Can't create socket");
+  }
+
+  m_socketOptions->applyToListener(serverHandle, true);
+
+  if(bind(serverHandle, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::uring::ServerConnectionProvider::instantiateServer()]: Can't bind to address");
+  }
+
+  if(listen(serverHandle, m_socketOptions->backlog) < 0) {
+    ::close(serverHandle);
+    throw std::runtime_error("[oatpp::libressl::uring::ServerConnectionProvider::instantiateServer()]: Failed to listen");
+  }
+
+  return serverHandle;
+
+}
+
+void ServerConnectionProvider::close() {
+  if(!m_closed) {
+    m_closed = true;
+    ::close(m_serverHandle);
+  }
+}
+
+std::shared_ptr<oatpp::data::stream::IOStream> ServerConnectionProvider::getConnection() {
+
+  data::v_io_handle handle = accept(m_serverHandle, nullptr, nullptr);
+
+  if(handle < 0) {
+    v_int32 error = errno;
+    if(error != EAGAIN && error != EWOULDBLOCK) {
+      OATPP_LOGD("[oatpp::libressl::uring::ServerConnectionProvider::getConnection()]", "Error: %d", error);
+    }
+    return nullptr;
+  }
+
+#ifdef SO_NOSIGPIPE
+  int yes = 1;
+  if(setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(int)) < 0) {
+    OATPP_LOGD("[oatpp::libressl::uring::ServerConnectionProvider::getConnection()]", "Warning failed to set %s for socket", "SO_NOSIGPIPE");
+  }
+#endif
+
+  m_socketOptions->applyToAccepted(handle, true);
+
+  return Socket::createShared(m_ring, handle, !m_nonBlocking);
+
+}
+
+}}}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_uring_ServerConnectionProvider_hpp
+#define oatpp_libressl_uring_ServerConnectionProvider_hpp
+
+#include "Socket.hpp"
+
+#include "oatpp-libressl/SocketOptions.hpp"
+
+#include "oatpp/network/ConnectionProvider.hpp"
+
+namespace oatpp { namespace libressl { namespace uring {
+
+/**
+ * Plain TCP server connection provider which gives &id:oatpp::libressl::uring::Socket; streams.
+ * Extends &id:oatpp::base::Countable;, &id:oatpp::network::ServerConnectionProvider;.
+ * Pass it to &id:oatpp::libressl::server::ConnectionProvider; to run TLS over io_uring:
+ * ```
+ * auto ring = oatpp::libressl::uring::Ring::createShared();
+ * auto tcp = oatpp::libressl::uring::ServerConnectionProvider::createShared(ring, 443, true);
+ * auto tls = oatpp::libressl::server::ConnectionProvider::createShared(config, tcp);
+ * ```
+ */
+class ServerConnectionProvider : public oatpp::base::Countable, public oatpp::network::ServerConnectionProvider {
+private:
+  std::shared_ptr<Ring> m_ring;
+  v_word16 m_port;
+  bool m_nonBlocking;
+  bool m_closed;
+  std::shared_ptr<SocketOptions> m_socketOptions;
+  data::v_io_handle m_serverHandle;
+private:
+  data::v_io_handle instantiateServer();
+public:
+
+  /**
+   * Constructor.
+   * @param ring - &id:oatpp::libressl::uring::Ring;.
+   * @param port - port to listen on.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
+   */
+  ServerConnectionProvider(const std::shared_ptr<Ring>& ring, v_word16 port, bool nonBlocking = false,
+                           const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Create shared ServerConnectionProvider.
+   * @param ring - &id:oatpp::libressl::uring::Ring;.
+   * @param port - port to listen on.
+   * @param nonBlocking - set `true` to provide non-blocking &id:oatpp::data::stream::IOStream; for connection.
+   * `false` for blocking &id:oatpp::data::stream::IOStream;. Default `false`.
+   * @param socketOptions - &id:oatpp::libressl::SocketOptions; for listening and accepted sockets. `nullptr` - defaults.
+   * @return - `std::shared_ptr` to ServerConnectionProvider.
+   */
+  static std::shared_ptr<ServerConnectionProvider> createShared(const std::shared_ptr<Ring>& ring,
+                                                                v_word16 port,
+                                                                bool nonBlocking = false,
+                                                                const std::shared_ptr<SocketOptions>& socketOptions = nullptr);
+
+  /**
+   * Virtual destructor.
+   */
+  ~ServerConnectionProvider();
+
+  /**
+   * Close listening socket.
+   */
+  void close() override;
+
+  /**
+   * Accept connection.
+   * @return - &id:oatpp::libressl::uring::Socket;.
+   */
+  std::shared_ptr<IOStream> getConnection() override;
+
+  /**
+   * No need to implement this. Connections are accepted in a separate thread with the blocking accept().
+   */
+  oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> getConnectionAsync() override {
+    throw std::runtime_error("oatpp::libressl::uring::ServerConnectionProvider::getConnectionAsync not implemented.");
+  }
+
+};
+
+}}}
+
+#endif /* oatpp_libressl_uring_ServerConnectionProvider_hpp */
@@ -0,0 +1,343 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "Socket.hpp"
+
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace oatpp { namespace libressl { namespace uring {
+
+namespace {
+#ifdef MSG_NOSIGNAL
+  const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+  const int SEND_FLAGS = 0;
+#endif
+
+  /*
+   * Operation didn't fail - resubmit it.
+   * Ring submits operations of all sockets in batches, and io_uring cancels in-flight operations
+   * of the thread which submitted them when the thread exits - it may be other socket's thread.
+   */
+  bool isRetryResult(v_int32 result) {
+    return result == -EINTR || result == -EAGAIN || result == -ECANCELED;
+  }
+
+}
+
+Socket::Socket(const std::shared_ptr<Ring>& ring, data::v_io_handle handle, bool blocking)
+  : m_ring(ring)
+  , m_handle(handle)
+  , m_blocking(blocking)
+  , m_closed(false)
+  , m_readBufferIndex(-1)
+  , m_readBuffer(nullptr)
+  , m_readPosition(0)
+  , m_readLimit(0)
+  , m_readResult(1)
+  , m_writeBufferIndex(-1)
+  , m_writeBuffer(nullptr)
+  , m_writeOffset(0)
+  , m_writeLimit(0)
+  , m_writeResult(0)
+{
+
+  int flags = fcntl(m_handle, F_GETFL);
+  if(flags < 0) {
+    flags = 0;
+  }
+
+  if(m_ring && m_ring->isAvailable()) {
+
+    m_readBufferIndex = m_ring->acquireBuffer();
+    m_writeBufferIndex = m_ring->acquireBuffer();
+
+    if(m_readBufferIndex >= 0 && m_writeBufferIndex >= 0) {
+      m_readBuffer = m_ring->getBuffer(m_readBufferIndex);
+      m_writeBuffer = m_ring->getBuffer(m_writeBufferIndex);
+    } else {
+      /* registered buffers are exhausted */
+      m_ring->releaseBuffer(m_readBufferIndex);
+      m_ring->releaseBuffer(m_writeBufferIndex);
+      m_readBufferIndex = -1;
+      m_writeBufferIndex = -1;
+      m_ownBuffers.reset(new v_char8[2 * (size_t) m_ring->getBufferSize()]);
+      m_readBuffer = m_ownBuffers.get();
+      m_writeBuffer = m_ownBuffers.get() + m_ring->getBufferSize();
+    }
+
+    /* ring provides asynchrony. With O_NONBLOCK io_uring would complete operations with EAGAIN */
+    fcntl(m_handle, F_SETFL, flags & ~O_NONBLOCK);
+
+  } else if(m_blocking) {
+    fcntl(m_handle, F_SETFL, flags & ~O_NONBLOCK);
+  } else {
+    fcntl(m_handle, F_SETFL, flags | O_NONBLOCK);
+  }
+
+}
+
+std::shared_ptr<Socket> Socket::createShared(const std::shared_ptr<Ring>& ring, data::v_io_handle handle, bool blocking) {
+  return std::make_shared<Socket>(ring, handle, blocking);
+}
+
+Socket::~Socket() {
+  close();
+}
+
+bool Socket::submitRead() {
+  m_readPosition = 0;
+  m_readLimit = 0;
+  return m_ring->submit(&m_readOperation, Ring::READ, m_handle, m_readBuffer, m_ring->getBufferSize(), m_readBufferIndex);
+}
+
+bool Socket::submitWrite() {
+  return m_ring->submit(&m_writeOperation, Ring::WRITE, m_handle, m_writeBuffer + m_writeOffset,
+                        m_writeLimit - m_writeOffset, m_writeBufferIndex);
+}
+
+bool Socket::await(Ring::Operation* operation) {
+  if(operation->isPending()) {
+    if(m_blocking) {
+      m_ring->wait(operation);
+    } else {
+      m_ring->poll();
+    }
+  }
+  return operation->isDone();
+}
+
+data::v_io_size Socket::takeBuffered(void *buff, data::v_io_size count) {
+  data::v_io_size size = m_readLimit - m_readPosition;
+  if(size > count) {
+    size = count;
+  }
+  std::memcpy(buff, m_readBuffer + m_readPosition, size);
+  m_readPosition += size;
+  if(m_readPosition == m_readLimit) {
+    /* read-ahead. If ring is full - read is submitted on next call */
+    submitRead();
+  }
+  return size;
+}
+
+data::v_io_size Socket::completeWrite() {
+
+  while(true) {
+
+    if(m_writeResult < 0) {
+      return m_writeResult;
+    }
+
+    if(m_writeOperation.isPending() && !await(&m_writeOperation)) {
+      return data::IOError::WAIT_RETRY;
+    }
+
+    if(m_writeOperation.isDone()) {
+      auto result = m_writeOperation.takeResult();
+      if(result > 0) {
+        m_writeOffset += result;
+      } else if(!isRetryResult(result)) {
+        m_writeResult = data::IOError::BROKEN_PIPE;
+        return m_writeResult;
+      }
+    }
+
+    if(m_writeOffset >= m_writeLimit) {
+      m_writeOffset = 0;
+      m_writeLimit = 0;
+      return 0;
+    }
+
+    /* partial write - send the rest */
+    if(submitWrite()) {
+      if(m_blocking) {
+        m_ring->flush();
+      } else {
+        m_ring->poll();
+      }
+    } else if(m_blocking) {
+      m_ring->flush();
+      std::this_thread::yield();
+    } else {
+      m_ring->poll();
+      return data::IOError::WAIT_RETRY;
+    }
+
+  }
+
+}
+
+data::v_io_size Socket::readSocket(void *buff, data::v_io_size count) {
+  auto result = ::recv(m_handle, buff, count, 0);
+  if(result >= 0) {
+    return result;
+  }
+  auto error = errno;
+  if(error == EAGAIN || error == EWOULDBLOCK) {
+    return data::IOError::WAIT_RETRY;
+  } else if(error == EINTR) {
+    return data::IOError::RETRY;
+  }
+  return data::IOError::BROKEN_PIPE;
+}
+
+data::v_io_size Socket::writeSocket(const void *buff, data::v_io_size count) {
+  auto result = ::send(m_handle, buff, count, SEND_FLAGS);
+  if(result >= 0) {
+    return result;
+  }
+  auto error = errno;
+  if(error == EAGAIN || error == EWOULDBLOCK) {
+    return data::IOError::WAIT_RETRY;
+  } else if(error == EINTR) {
+    return data::IOError::RETRY;
+  }
+  return data::IOError::BROKEN_PIPE;
+}
+
+data::v_io_size Socket::read(void *buff, data::v_io_size count) {
+
+  if(!isRingUsed()) {
+    return readSocket(buff, count);
+  }
+
+  if(m_readPosition < m_readLimit) {
+    return takeBuffered(buff, count);
+  }
+
+  if(m_readResult <= 0) {
+    return m_readResult;
+  }
+
+  while(true) {
+
+    if(!m_readOperation.isPending() && !m_readOperation.isDone() && !submitRead()) {
+      if(!m_blocking) {
+        m_ring->poll();
+        return data::IOError::WAIT_RETRY;
+      }
+      m_ring->flush();
+      std::this_thread::yield();
+      continue;
+    }
+
+    if(!await(&m_readOperation)) {
+      return data::IOError::WAIT_RETRY;
+    }
+
+    auto result = m_readOperation.takeResult();
+    if(result > 0) {
+      m_readPosition = 0;
+      m_readLimit = result;
+      return takeBuffered(buff, count);
+    }
+
+    if(!isRetryResult(result)) {
+      m_readResult = (result == 0) ? 0 : data::IOError::BROKEN_PIPE;
+      return m_readResult;
+    }
+
+  }
+
+}
+
+data::v_io_size Socket::write(const void *buff, data::v_io_size count) {
+
+  if(!isRingUsed()) {
+    return writeSocket(buff, count);
+  }
+
+  auto result = completeWrite();
+  if(result != 0) {
+    return result;
+  }
+
+  data::v_io_size size = m_ring->getBufferSize();
+  if(size > count) {
+    size = count;
+  }
+
+  std::memcpy(m_writeBuffer, buff, size);
+  m_writeOffset = 0;
+  m_writeLimit = (v_int32) size;
+
+  while(!submitWrite()) {
+    if(!m_blocking) {
+      m_writeLimit = 0;
+      m_ring->poll();
+      return data::IOError::WAIT_RETRY;
+    }
+    m_ring->flush();
+    std::this_thread::yield();
+  }
+
+  if(m_blocking) {
+    m_ring->flush();
+  } else {
+    m_ring->poll();
+  }
+
+  return size;
+
+}
+
+data::v_io_size Socket::close() {
+
+  if(m_closed) {
+    return m_writeResult < 0 ? m_writeResult : 0;
+  }
+  m_closed = true;
+
+  data::v_io_size result = 0;
+
+  if(isRingUsed()) {
+
+    /* kernel must be done with buffers before they are released */
+    m_blocking = true;
+    result = completeWrite();
+
+    ::shutdown(m_handle, SHUT_RDWR);
+    if(m_readOperation.isPending()) {
+      m_ring->wait(&m_readOperation);
+    }
+
+    m_ring->releaseBuffer(m_readBufferIndex);
+    m_ring->releaseBuffer(m_writeBufferIndex);
+
+  }
+
+  ::close(m_handle);
+
+  return result;
+
+}
+
+}}}
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#ifndef oatpp_libressl_uring_Socket_hpp
+#define oatpp_libressl_uring_Socket_hpp
+
+#include "Ring.hpp"
+
+#include "oatpp/core/data/stream/Stream.hpp"
+
+namespace oatpp { namespace libressl { namespace uring {
+
+/**
+ * Socket stream doing I/O through &id:oatpp::libressl::uring::Ring;. Extends &id:oatpp::base::Countable; and &id:oatpp::data::stream::IOStream;.
+ * Use it as transport of &id:oatpp::libressl::Connection; via libtls callback I/O - see &id:oatpp::libressl::uring::ServerConnectionProvider;.<br>
+ * Reads are read-ahead: as soon as the read buffer is drained next read is submitted.
+ * Writes are write-behind: data is copied to the write buffer and `write()` returns before the kernel sends it.
+ * Errors of write-behind are reported on the next write.<br>
+ * Non-blocking socket returns &id:oatpp::data::IOError::WAIT_RETRY; while operation is in flight.
+ * Blocking socket waits for completion.<br>
+ * If the ring is not available socket does plain `recv()`/`send()`.
+ */
+class Socket : public oatpp::base::Countable, public oatpp::data::stream::IOStream {
+private:
+  std::shared_ptr<Ring> m_ring;
+  data::v_io_handle m_handle;
+  bool m_blocking;
+  bool m_closed;
+  std::unique_ptr<v_char8[]> m_ownBuffers;
+private:
+  Ring::Operation m_readOperation;
+  v_int32 m_readBufferIndex;
+  v_char8* m_readBuffer;
+  v_int32 m_readPosition;
+  v_int32 m_readLimit;
+  data::v_io_size m_readResult;
+private:
+  Ring::Operation m_writeOperation;
+  v_int32 m_writeBufferIndex;
+  v_char8* m_writeBuffer;
+  v_int32 m_writeOffset;
+  v_int32 m_writeLimit;
+  data::v_io_size m_writeResult;
+private:
+  bool isRingUsed() {
+    return m_readBuffer != nullptr;
+  }
+  bool submitRead();
+  bool submitWrite();
+  bool await(Ring::Operation* operation);
+  data::v_io_size takeBuffered(void *buff, data::v_io_size count);
+  data::v_io_size completeWrite();
+  data::v_io_size readSocket(void *buff, data::v_io_size count);
+  data::v_io_size writeSocket(const void *buff, data::v_io_size count);
+public:
+
+  /**
+   * Constructor.
+   * @param ring - &id:oatpp::libressl::uring::Ring;.
+   * @param handle - connected socket. Socket takes ownership of the handle.
+   * @param blocking - `true` for blocking socket.
+   */
+  Socket(const std::shared_ptr<Ring>& ring, data::v_io_handle handle, bool blocking);
+
+  /**
+   * Create shared Socket.
+   * @param ring - &id:oatpp::libressl::uring::Ring;.
+   * @param handle - connected socket. Socket takes ownership of the handle.
+   * @param blocking - `true` for blocking socket.
+   * @return - `std::shared_ptr` to Socket.
+   */
+  static std::shared_ptr<Socket> createShared(const std::shared_ptr<Ring>& ring, data::v_io_handle handle, bool blocking);
+
+  /**
+   * Virtual destructor. Closes socket.
+   */
+  ~Socket();
+
+  /**
+   * Implementation of &id:oatpp::data::stream::OutputStream::write; method.<br>
+   * When the ring is used, returned bytes are queued, not sent yet. If sending them fails the error is returned
+   * by the next write, or by &l:Socket::close (); for the last write.
+   * @param buff - data to write to stream.
+   * @param count - data size.
+   * @return - amount of bytes taken.
+   */
+  data::v_io_size write(const void *buff, data::v_io_size count) override;
+
+  /**
+   * Implementation of &id:oatpp::data::stream::InputStream::read; method.
+   * @param buff - buffer to read data to.
+   * @param count - buffer size.
+   * @return - actual amount of bytes read.
+   */
+  data::v_io_size read(void *buff, data::v_io_size count) override;
+
+  /**
+   * Wait for pending writes, cancel pending read and close handle. Blocks until the kernel is done with socket buffers.
+   * @return - `0` if all written data was sent, &id:oatpp::data::IOError::BROKEN_PIPE; if sending of queued data failed.
+   */
+  data::v_io_size close();
+
+  /**
+   * Get socket handle.
+   * @return - &id:oatpp::data::v_io_handle;.
+   */
+  data::v_io_handle getHandle() {
+    return m_handle;
+  }
+
+};
+
+}}}
+
+#endif /* oatpp_libressl_uring_Socket_hpp */
@@ -0,0 +1,207 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ConfigTest.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/MemoryPipe.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Config Config;
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::MemoryPipe MemoryPipe;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+  /* negotiated parameters of server connection */
+  std::shared_ptr<const oatpp::libressl::TlsInfo> negotiate(const std::shared_ptr<Config>& serverConfig,
+                                                            const std::shared_ptr<Config>& clientConfig)
+  {
+
+    Connection::TLSHandle serverHandle = tls_server();
+    OATPP_ASSERT(tls_configure(serverHandle, serverConfig->getTLSConfig()) == 0);
+
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    OATPP_ASSERT(Utils::createMemoryPair(serverHandle, clientConfig, server, client));
+
+    auto info = server->getTlsInfo();
+    auto alpn = client->getAlpnProtocol();
+    OATPP_ASSERT((!alpn && !info->alpn) || (alpn && info->alpn && alpn->std_str() == info->alpn->std_str()));
+
+    tls_free(serverHandle);
+    return info;
+
+  }
+
+  /* client config presenting certificate of the keypair. No certificate if keyPair is nullptr */
+  std::shared_ptr<Config> createClientConfig(const KeyPair* keyPair) {
+    auto config = KeyPair::createClientConfig();
+    if(keyPair != nullptr) {
+      OATPP_ASSERT(tls_config_set_keypair_mem(config->getTLSConfig(),
+                                              (const uint8_t*) keyPair->certPem.data(), keyPair->certPem.size(),
+                                              (const uint8_t*) keyPair->keyPem.data(), keyPair->keyPem.size()) == 0);
+    }
+    return config;
+  }
+
+  /* check if server accepts the client - client certificate is verified as server ConnectionProvider does it */
+  bool authenticate(const std::shared_ptr<Config>& serverConfig, const std::shared_ptr<Config>& clientConfig) {
+
+    Connection::TLSHandle serverHandle = tls_server();
+    OATPP_ASSERT(tls_configure(serverHandle, serverConfig->getTLSConfig()) == 0);
+
+    std::shared_ptr<MemoryPipe::Endpoint> serverStream;
+    std::shared_ptr<MemoryPipe::Endpoint> clientStream;
+    MemoryPipe::createPair(serverStream, clientStream);
+
+    Connection::TLSHandle serverConnectionHandle;
+    OATPP_ASSERT(tls_accept_cbs(serverHandle, &serverConnectionHandle,
+                                Connection::readCallback, Connection::writeCallback, serverStream.get()) == 0);
+    auto server = Connection::createShared(serverConnectionHandle, serverStream);
+    server->setCertVerifier(serverConfig->getClientCertVerifier());
+
+    Connection::TLSHandle clientHandle = tls_client();
+    OATPP_ASSERT(tls_configure(clientHandle, clientConfig->getTLSConfig()) == 0);
+    OATPP_ASSERT(tls_connect_cbs(clientHandle, Connection::readCallback, Connection::writeCallback,
+                                 clientStream.get(), "localhost") == 0);
+    auto client = Connection::createShared(clientHandle, clientStream);
+
+    data::v_io_size serverResult = data::IOError::WAIT_RETRY;
+    for(v_int32 i = 0; i < 100 && serverResult == data::IOError::WAIT_RETRY; i ++) {
+      client->handshake();
+      serverResult = server->handshake();
+    }
+    OATPP_ASSERT(serverResult != data::IOError::WAIT_RETRY);
+
+    tls_free(serverHandle);
+    return serverResult == 0;
+
+  }
+
+}
+
+void ConfigTest::onRun() {
+
+  auto keyPair = KeyPair::generate("localhost");
+
+  {
+    OATPP_LOGD(TAG, "ALPN...");
+
+    auto serverConfig = keyPair.createServerConfig();
+    serverConfig->setAlpnProtocols({"h2", "http/1.1"});
+
+    /* protocol supported by both */
+    auto clientConfig = KeyPair::createClientConfig();
+    clientConfig->setAlpnProtocols({"http/1.1"});
+    auto info = negotiate(serverConfig, clientConfig);
+    OATPP_ASSERT(info->alpn && info->alpn->std_str() == "http/1.1");
+
+    /* server preference */
+    clientConfig = KeyPair::createClientConfig();
+    clientConfig->setAlpnProtocols({"http/1.1", "h2"});
+    info = negotiate(serverConfig, clientConfig);
+    OATPP_ASSERT(info->alpn && info->alpn->std_str() == "h2");
+
+    /* client doesn't offer ALPN */
+    info = negotiate(serverConfig, KeyPair::createClientConfig());
+    OATPP_ASSERT(!info->alpn);
+  }
+
+  {
+    OATPP_LOGD(TAG, "presets...");
+
+    /* client offers both AES-GCM and ChaCha20 - server order wins */
+    auto serverConfig = keyPair.createServerConfig();
+    serverConfig->setPreset(Config::CIPHERS_AES_GCM_FIRST, Config::PROTOCOLS_TLS12_ONLY);
+    auto info = negotiate(serverConfig, KeyPair::createClientConfig());
+    OATPP_ASSERT(info->version->std_str() == "TLSv1.2");
+    OATPP_ASSERT(info->cipher->std_str().find("AES128-GCM") != std::string::npos);
+
+    serverConfig = keyPair.createServerConfig();
+    serverConfig->setPreset(Config::CIPHERS_CHACHA20_FIRST, Config::PROTOCOLS_TLS12_ONLY);
+    info = negotiate(serverConfig, KeyPair::createClientConfig());
+    OATPP_ASSERT(info->cipher->std_str().find("CHACHA20") != std::string::npos);
+
+    serverConfig = keyPair.createServerConfig();
+    serverConfig->setPreset(Config::CIPHERS_AUTO, Config::PROTOCOLS_TLS12_ONLY);
+    info = negotiate(serverConfig, KeyPair::createClientConfig());
+    OATPP_ASSERT(info->cipher->std_str().find(Config::hasHardwareAes() ? "AES128-GCM" : "CHACHA20") != std::string::npos);
+
+#ifdef TLS_PROTOCOL_TLSv1_3
+    serverConfig = keyPair.createServerConfig();
+    serverConfig->setPreset(Config::CIPHERS_AUTO, Config::PROTOCOLS_TLS13_ONLY);
+    info = negotiate(serverConfig, KeyPair::createClientConfig());
+    OATPP_ASSERT(info->version->std_str() == "TLSv1.3");
+#endif
+  }
+
+  {
+    OATPP_LOGD(TAG, "client auth...");
+
+    auto trusted = KeyPair::generate("trusted");
+    auto untrusted = KeyPair::generate("untrusted");
+
+    /* certificate is not requested */
+    auto serverConfig = keyPair.createServerConfig();
+    serverConfig->setClientCaMem(trusted.certPem.c_str());
+    OATPP_ASSERT(!serverConfig->getClientCertVerifier());
+    OATPP_ASSERT(authenticate(serverConfig, createClientConfig(&untrusted)));
+
+    serverConfig->setClientAuth(Config::CLIENT_AUTH_OPTIONAL);
+    OATPP_ASSERT(serverConfig->getClientCertVerifier());
+    OATPP_ASSERT(!authenticate(serverConfig, createClientConfig(&untrusted)));
+    OATPP_ASSERT(authenticate(serverConfig, createClientConfig(nullptr)));
+    OATPP_ASSERT(authenticate(serverConfig, createClientConfig(&trusted)));
+
+    serverConfig->setClientAuth(Config::CLIENT_AUTH_REQUIRED);
+    OATPP_ASSERT(!authenticate(serverConfig, createClientConfig(&untrusted)));
+    OATPP_ASSERT(!authenticate(serverConfig, createClientConfig(nullptr)));
+    OATPP_ASSERT(authenticate(serverConfig, createClientConfig(&trusted)));
+
+    /* verified chain is cached - it expires in a day, cache entry in an hour */
+    OATPP_ASSERT(serverConfig->getClientCertVerifier()->getCacheHits() == 1);
+
+    /* chains are no longer verified by libtls - client auth can't be turned off */
+    bool thrown = false;
+    try {
+      serverConfig->setClientAuth(Config::CLIENT_AUTH_NONE);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    OATPP_ASSERT(thrown);
+    OATPP_ASSERT(serverConfig->getClientAuth() == Config::CLIENT_AUTH_REQUIRED);
+    OATPP_ASSERT(!authenticate(serverConfig, createClientConfig(&untrusted)));
+  }
+
+}
+
+}}}
@@ -0,0 +1,246 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ConnectionReserveTest.hpp"
+
+#include "oatpp-libressl/client/ConnectionReserve.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::libressl::client::ConnectionReserve ConnectionReserve;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+  class ReadyCoroutine : public oatpp::async::CoroutineWithResult<ReadyCoroutine, const std::shared_ptr<oatpp::data::stream::IOStream>&> {
+  private:
+    std::shared_ptr<oatpp::data::stream::IOStream> m_connection;
+  public:
+
+    ReadyCoroutine(const std::shared_ptr<oatpp::data::stream::IOStream>& connection)
+      : m_connection(connection)
+    {}
+
+    Action act() override {
+      return _return(m_connection);
+    }
+
+  };
+
+  /* handshaked TLS pair over non-blocking socketpair - so that the reserve sees real socket state */
+  class Upstream {
+  private:
+    Connection::TLSHandle m_serverHandle;
+    std::shared_ptr<oatpp::libressl::Config> m_clientConfig;
+    std::mutex m_lock;
+    std::list<std::pair<std::shared_ptr<Connection>, std::shared_ptr<Connection>>> m_pairs;
+  public:
+
+    Upstream(const std::shared_ptr<oatpp::libressl::Config>& serverConfig)
+      : m_serverHandle(tls_server())
+      , m_clientConfig(KeyPair::createClientConfig())
+    {
+      OATPP_ASSERT(tls_configure(m_serverHandle, serverConfig->getTLSConfig()) == 0);
+    }
+
+    ~Upstream() {
+      m_pairs.clear();
+      tls_free(m_serverHandle);
+    }
+
+    ConnectionReserve::ConnectionStarter connect() {
+
+      int fds[2];
+      OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+      fcntl(fds[0], F_SETFL, O_NONBLOCK);
+      fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+      Connection::TLSHandle serverConnectionHandle;
+      OATPP_ASSERT(tls_accept_socket(m_serverHandle, &serverConnectionHandle, fds[0]) == 0);
+      auto server = Connection::createShared(serverConnectionHandle, fds[0]);
+
+      Connection::TLSHandle clientHandle = tls_client();
+      OATPP_ASSERT(tls_configure(clientHandle, m_clientConfig->getTLSConfig()) == 0);
+      OATPP_ASSERT(tls_connect_socket(clientHandle, fds[1], "localhost") == 0);
+      auto client = Connection::createShared(clientHandle, fds[1]);
+
+      data::v_io_size clientResult;
+      data::v_io_size serverResult;
+      do {
+        clientResult = client->handshake();
+        serverResult = server->handshake();
+        OATPP_ASSERT(clientResult == 0 || clientResult == data::IOError::WAIT_RETRY);
+        OATPP_ASSERT(serverResult == 0 || serverResult == data::IOError::WAIT_RETRY);
+      } while(clientResult != 0 || serverResult != 0);
+
+      {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_pairs.push_back({client, server});
+      }
+
+      return ReadyCoroutine::startForResult(client);
+
+    }
+
+    v_int32 getConnectCount() {
+      std::lock_guard<std::mutex> lock(m_lock);
+      return (v_int32) m_pairs.size();
+    }
+
+    std::shared_ptr<Connection> getServer(const std::shared_ptr<Connection>& client) {
+      std::lock_guard<std::mutex> lock(m_lock);
+      for(auto& pair : m_pairs) {
+        if(pair.first == client) {
+          return pair.second;
+        }
+      }
+      return nullptr;
+    }
+
+    /* server closes all connections made so far - as on its idle timeout */
+    std::list<std::shared_ptr<Connection>> closeAll() {
+      std::lock_guard<std::mutex> lock(m_lock);
+      std::list<std::shared_ptr<Connection>> clients;
+      for(auto& pair : m_pairs) {
+        pair.second->closeWrite();
+        pair.second->close();
+        clients.push_back(pair.first);
+      }
+      return clients;
+    }
+
+  };
+
+  bool waitFor(const std::function<bool()>& condition) {
+    for(v_int32 i = 0; i < 500; i ++) {
+      if(condition()) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+}
+
+void ConnectionReserveTest::onRun() {
+
+  /* close_notify of the reserve may be written to the socket which peer has already closed */
+  signal(SIGPIPE, SIG_IGN);
+
+  auto keyPair = KeyPair::generate("localhost");
+  auto serverConfig = keyPair.createServerConfig();
+  auto executor = std::make_shared<oatpp::async::Executor>(1, 1, 1);
+
+  {
+    OATPP_LOGD(TAG, "take and refill...");
+
+    Upstream upstream(serverConfig);
+    auto reserve = ConnectionReserve::createShared(executor, 2, 0, [&upstream]() {
+      return upstream.connect();
+    });
+    reserve->start();
+
+    OATPP_ASSERT(waitFor([&reserve]{ return reserve->getIdleCount() == 2; }));
+    OATPP_ASSERT(upstream.getConnectCount() == 2);
+
+    auto connection = reserve->take();
+    OATPP_ASSERT(connection);
+
+    /* taken connection is handshaked and usable */
+    auto server = upstream.getServer(connection);
+    OATPP_ASSERT(server);
+    const char* message = "ping";
+    v_char8 buffer[4];
+    OATPP_ASSERT(Utils::writeExactly(connection.get(), message, 4));
+    OATPP_ASSERT(Utils::readExactly(server.get(), buffer, 4));
+    OATPP_ASSERT(std::memcmp(buffer, message, 4) == 0);
+
+    /* missing connection is replaced */
+    OATPP_ASSERT(waitFor([&reserve]{ return reserve->getIdleCount() == 2; }));
+    OATPP_ASSERT(upstream.getConnectCount() == 3);
+
+    OATPP_LOGD(TAG, "eviction of connections closed by peer...");
+
+    auto closed = upstream.closeAll();
+
+    /* closed connection is never given away */
+    for(v_int32 i = 0; i < 2; i ++) {
+      auto taken = reserve->take();
+      OATPP_ASSERT(!taken || std::find(closed.begin(), closed.end(), taken) == closed.end());
+    }
+
+    OATPP_ASSERT(waitFor([&reserve, &upstream]{ return reserve->getIdleCount() == 2 && upstream.getConnectCount() >= 5; }));
+    auto fresh = reserve->take();
+    OATPP_ASSERT(fresh);
+    OATPP_ASSERT(std::find(closed.begin(), closed.end(), fresh) == closed.end());
+
+    reserve->stop();
+    OATPP_ASSERT(reserve->getIdleCount() == 0);
+
+    /* connect function is not called after stop */
+    v_int32 count = upstream.getConnectCount();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    OATPP_ASSERT(upstream.getConnectCount() == count);
+
+    executor->waitTasksFinished();
+  }
+
+  {
+    OATPP_LOGD(TAG, "rotation of idle connections...");
+
+    Upstream upstream(serverConfig);
+    auto reserve = ConnectionReserve::createShared(executor, 1, 100 * 1000, [&upstream]() {
+      return upstream.connect();
+    });
+    reserve->start();
+
+    OATPP_ASSERT(waitFor([&upstream]{ return upstream.getConnectCount() >= 3; }));
+
+    reserve->stop();
+    executor->waitTasksFinished();
+  }
+
+  executor->stop();
+  executor->join();
+
+}
+
+}}}
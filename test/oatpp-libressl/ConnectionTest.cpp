@@ -0,0 +1,221 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ConnectionTest.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/MemoryPipe.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <signal.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::MemoryPipe MemoryPipe;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+}
+
+void ConnectionTest::onRun() {
+
+  auto keyPair = KeyPair::generate("localhost");
+  auto serverConfig = keyPair.createServerConfig();
+
+  Connection::TLSHandle serverHandle = tls_server();
+  OATPP_ASSERT(tls_configure(serverHandle, serverConfig->getTLSConfig()) == 0);
+
+  {
+    OATPP_LOGD(TAG, "buffered input...");
+
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    OATPP_ASSERT(Utils::createMemoryPair(serverHandle, KeyPair::createClientConfig(), server, client));
+
+    const v_char8* data;
+
+    bool thrown = false;
+    try {
+      client->peek(data);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    OATPP_ASSERT(thrown);
+
+    server->setReadBuffer(16);
+    OATPP_ASSERT(server->getReadBufferSize() == 16);
+
+    /* nothing sent yet */
+    OATPP_ASSERT(server->peek(data) == data::IOError::WAIT_RETRY);
+    OATPP_ASSERT(data == nullptr);
+
+    const char* message = "0123456789abcdefghijklmnopqrstuvwxyzABCD";
+    OATPP_ASSERT(Utils::writeExactly(client.get(), message, 40));
+
+    /* one TLS record - buffer takes its first 16 bytes */
+    auto size = server->peek(data);
+    OATPP_ASSERT(size == 16);
+    OATPP_ASSERT(std::memcmp(data, message, 16) == 0);
+    OATPP_ASSERT(server->getBufferedSize() == 16);
+
+    /* peek doesn't take data */
+    OATPP_ASSERT(server->peek(data) == 16);
+
+    server->consume(2);
+    OATPP_ASSERT(server->getBufferedSize() == 14);
+
+    /* small read is served from the buffer */
+    v_char8 buffer[32];
+    OATPP_ASSERT(server->read(buffer, 3) == 3);
+    OATPP_ASSERT(std::memcmp(buffer, &message[2], 3) == 0);
+    OATPP_ASSERT(server->getBufferedSize() == 11);
+
+    /* consume more than buffered drops the buffer */
+    server->consume(1000);
+    OATPP_ASSERT(server->getBufferedSize() == 0);
+
+    /* read of buffer size and more bypasses the buffer */
+    OATPP_ASSERT(Utils::readExactly(server.get(), buffer, 24));
+    OATPP_ASSERT(std::memcmp(buffer, &message[16], 24) == 0);
+    OATPP_ASSERT(server->getBufferedSize() == 0);
+  }
+
+  {
+    OATPP_LOGD(TAG, "rate-limited write...");
+
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    OATPP_ASSERT(Utils::createMemoryPair(serverHandle, KeyPair::createClientConfig(), server, client));
+
+    auto serverStream = std::static_pointer_cast<MemoryPipe::Endpoint>(server->getStream());
+
+    /* 1 byte per second - bucket is not refilled during the test */
+    auto limiter = oatpp::libressl::RateLimiter::createShared(1, 1000);
+    server->setWriteLimiters(limiter, nullptr);
+
+    v_char8 data[4000];
+    for(v_int32 i = 0; i < 4000; i ++) {
+      data[i] = (v_char8) i;
+    }
+
+    /* transport is full - record of the granted 1000 bytes is pending in libtls */
+    serverStream->setWriteBlocked(true);
+    OATPP_ASSERT(server->write(data, 4000) == data::IOError::WAIT_RETRY);
+
+    /* retry gets the pending grant back, though the bucket is empty */
+    serverStream->setWriteBlocked(false);
+    OATPP_ASSERT(server->write(data, 4000) == 1000);
+
+    /* grant is used up - non-blocking connection is throttled */
+    OATPP_ASSERT(server->write(data, 4000) == data::IOError::WAIT_RETRY);
+
+    v_char8 received[1000];
+    OATPP_ASSERT(Utils::readExactly(client.get(), received, 1000));
+    OATPP_ASSERT(std::memcmp(received, data, 1000) == 0);
+  }
+
+  {
+    OATPP_LOGD(TAG, "full-duplex...");
+
+    /* close_notify of the second connection is written to the socket which peer has already closed */
+    signal(SIGPIPE, SIG_IGN);
+
+    int fds[2];
+    OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    Connection::TLSHandle serverConnectionHandle;
+    OATPP_ASSERT(tls_accept_socket(serverHandle, &serverConnectionHandle, fds[0]) == 0);
+    auto server = Connection::createShared(serverConnectionHandle, fds[0]);
+
+    auto clientConfig = KeyPair::createClientConfig();
+    Connection::TLSHandle clientHandle = tls_client();
+    OATPP_ASSERT(tls_configure(clientHandle, clientConfig->getTLSConfig()) == 0);
+    OATPP_ASSERT(tls_connect_socket(clientHandle, fds[1], "localhost") == 0);
+    auto client = Connection::createShared(clientHandle, fds[1]);
+
+    server->setFullDuplex(true);
+    client->setFullDuplex(true);
+
+    /* blocking sockets, both sides write more than the socket buffer holds -
+     * completes only if the reader of the same connection runs while the writer waits */
+    const v_int32 size = 1024 * 1024;
+    std::vector<v_char8> toClient(size);
+    std::vector<v_char8> toServer(size);
+    for(v_int32 i = 0; i < size; i ++) {
+      toClient[i] = (v_char8) i;
+      toServer[i] = (v_char8) (i * 7);
+    }
+    std::vector<v_char8> atClient(size);
+    std::vector<v_char8> atServer(size);
+
+    std::atomic<v_int32> failures(0);
+
+    std::thread serverWriter([&] {
+      if(!Utils::writeExactly(server.get(), toClient.data(), size)) {
+        failures ++;
+      }
+    });
+    std::thread serverReader([&] {
+      if(!Utils::readExactly(server.get(), atServer.data(), size)) {
+        failures ++;
+      }
+    });
+    std::thread clientWriter([&] {
+      if(!Utils::writeExactly(client.get(), toServer.data(), size)) {
+        failures ++;
+      }
+    });
+    std::thread clientReader([&] {
+      if(!Utils::readExactly(client.get(), atClient.data(), size)) {
+        failures ++;
+      }
+    });
+
+    serverWriter.join();
+    serverReader.join();
+    clientWriter.join();
+    clientReader.join();
+
+    OATPP_ASSERT(failures == 0);
+    OATPP_ASSERT(atClient == toClient);
+    OATPP_ASSERT(atServer == toServer);
+    OATPP_ASSERT(!server->getLastError());
+    OATPP_ASSERT(!client->getLastError());
+  }
+
+  tls_free(serverHandle);
+
+}
+
+}}}
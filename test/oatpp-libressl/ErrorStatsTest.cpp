@@ -0,0 +1,157 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ErrorStatsTest.hpp"
+
+#include "oatpp-libressl/Connection.hpp"
+#include "oatpp-libressl/ErrorStats.hpp"
+
+#include <cstring>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+typedef oatpp::libressl::ErrorStats ErrorStats;
+
+/* fail client handshake over a socketpair, with errno left over from an unrelated call */
+ErrorStats::Type failHandshake(bool peerClosed, int staleErrno) {
+
+  int fds[2];
+  OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  if(peerClosed) {
+    ::close(fds[1]);
+  } else {
+    const char* garbage = "HTTP/1.1 400 Bad Request\r\n\r\n";
+    OATPP_ASSERT(::write(fds[1], garbage, std::strlen(garbage)) > 0);
+  }
+
+  auto config = tls_config_new();
+  auto tlsHandle = tls_client();
+  OATPP_ASSERT(tls_configure(tlsHandle, config) == 0);
+  OATPP_ASSERT(tls_connect_socket(tlsHandle, fds[0], "localhost") == 0);
+  auto connection = oatpp::libressl::Connection::createShared(tlsHandle, fds[0]);
+
+  v_int64 counts[ErrorStats::TYPES_COUNT];
+  for(v_int32 i = 0; i < ErrorStats::TYPES_COUNT; i ++) {
+    counts[i] = ErrorStats::getCount((ErrorStats::Type) i);
+  }
+
+  errno = staleErrno;
+  OATPP_ASSERT(connection->handshake() < 0);
+
+  connection.reset();
+  tls_config_free(config);
+  if(!peerClosed) {
+    ::close(fds[1]);
+  }
+
+  for(v_int32 i = 0; i < ErrorStats::TYPES_COUNT; i ++) {
+    if(ErrorStats::getCount((ErrorStats::Type) i) != counts[i]) {
+      return (ErrorStats::Type) i;
+    }
+  }
+  return ErrorStats::TYPES_COUNT;
+
+}
+
+/* transport of the peer which is gone */
+class BrokenStream : public oatpp::data::stream::IOStream {
+public:
+
+  data::v_io_size write(const void *buff, data::v_io_size count) override {
+    return data::IOError::BROKEN_PIPE;
+  }
+
+  data::v_io_size read(void *buff, data::v_io_size count) override {
+    return data::IOError::WAIT_RETRY;
+  }
+
+};
+
+ErrorStats::Type failStreamHandshake() {
+
+  auto stream = std::make_shared<BrokenStream>();
+
+  auto config = tls_config_new();
+  auto tlsHandle = tls_client();
+  OATPP_ASSERT(tls_configure(tlsHandle, config) == 0);
+  OATPP_ASSERT(tls_connect_cbs(tlsHandle, oatpp::libressl::Connection::readCallback, oatpp::libressl::Connection::writeCallback,
+                               stream.get(), "localhost") == 0);
+  auto connection = oatpp::libressl::Connection::createShared(tlsHandle, stream);
+
+  v_int64 before = ErrorStats::getCount(ErrorStats::PEER_RESET);
+  OATPP_ASSERT(connection->handshake() < 0);
+  OATPP_ASSERT(connection->getLastError());
+
+  connection.reset();
+  tls_config_free(config);
+
+  return ErrorStats::getCount(ErrorStats::PEER_RESET) != before ? ErrorStats::PEER_RESET : ErrorStats::TYPES_COUNT;
+
+}
+
+}
+
+void ErrorStatsTest::onRun() {
+
+  OATPP_ASSERT(ErrorStats::classify(ECONNRESET, true) == ErrorStats::PEER_RESET);
+  OATPP_ASSERT(ErrorStats::classify(EPIPE, false) == ErrorStats::PEER_RESET);
+  OATPP_ASSERT(ErrorStats::classify(0, false) == ErrorStats::HANDSHAKE);
+  OATPP_ASSERT(ErrorStats::classify(0, true) == ErrorStats::PROTOCOL);
+
+  /* system errors which are not peer resets */
+  OATPP_ASSERT(ErrorStats::classify(EBADF, true) == ErrorStats::OTHER);
+  OATPP_ASSERT(ErrorStats::classify(ENOMEM, false) == ErrorStats::OTHER);
+
+  /* burst of errors must be counted in full, but logged only once per interval */
+  ErrorStats::setLogInterval(60 * 1000 * 1000);
+
+  v_int64 before = ErrorStats::getCount(ErrorStats::PEER_RESET);
+  for(v_int32 i = 0; i < 10000; i ++) {
+    ErrorStats::onError(ErrorStats::PEER_RESET, "[ErrorStatsTest]", "connection reset by peer");
+  }
+  OATPP_ASSERT(ErrorStats::getCount(ErrorStats::PEER_RESET) - before == 10000);
+
+  /* ClientHello written to closed peer */
+  signal(SIGPIPE, SIG_IGN);
+  OATPP_ASSERT(failHandshake(true, 0) == ErrorStats::PEER_RESET);
+
+  /* peer is not TLS - stale ECONNRESET must not count as peer reset */
+  OATPP_ASSERT(failHandshake(false, ECONNRESET) == ErrorStats::HANDSHAKE);
+
+  /* stream error is passed to libtls as errno */
+  OATPP_ASSERT(failStreamHandshake() == ErrorStats::PEER_RESET);
+
+  ErrorStats::setLogInterval(1000 * 1000);
+
+}
+
+}}}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "ListenerHandoffTest.hpp"
+
+#include "oatpp-libressl/ListenerHandoff.hpp"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+#if defined(__linux__)
+  const char* const HANDOFF_PATH = "@oatpp-libressl-test-handoff";
+#else
+  const char* const HANDOFF_PATH = "/tmp/oatpp-libressl-test-handoff.sock";
+#endif
+
+  const v_int64 TIMEOUT_MICROS = 5 * 1000 * 1000;
+
+  v_word16 getPort(data::v_io_handle handle) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    std::memset(&addr, 0, sizeof(addr));
+    if(getsockname(handle, (struct sockaddr*) &addr, &length) != 0) {
+      return 0;
+    }
+    return ntohs(addr.sin_port);
+  }
+
+}
+
+void ListenerHandoffTest::onRun() {
+
+  data::v_io_handle listener = socket(AF_INET, SOCK_STREAM, 0);
+  OATPP_ASSERT(listener >= 0);
+
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = 0;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  OATPP_ASSERT(bind(listener, (struct sockaddr*) &addr, sizeof(addr)) == 0);
+  OATPP_ASSERT(listen(listener, 16) == 0);
+
+  v_word16 port = getPort(listener);
+  OATPP_ASSERT(port != 0);
+
+  /* no predecessor */
+  OATPP_ASSERT(oatpp::libressl::ListenerHandoff::receive(HANDOFF_PATH, TIMEOUT_MICROS) == -1);
+
+  std::atomic<bool> sent(false);
+  std::thread predecessor([listener, &sent]{
+    sent = oatpp::libressl::ListenerHandoff::send(HANDOFF_PATH, listener, TIMEOUT_MICROS);
+  });
+
+  /* successor retries until predecessor listens on the handoff path */
+  data::v_io_handle received = -1;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(TIMEOUT_MICROS);
+  while(received < 0 && std::chrono::steady_clock::now() < deadline) {
+    received = oatpp::libressl::ListenerHandoff::receive(HANDOFF_PATH, TIMEOUT_MICROS);
+    if(received < 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  predecessor.join();
+
+  OATPP_ASSERT(sent);
+  OATPP_ASSERT(received >= 0);
+  OATPP_ASSERT(received != listener);
+
+  /* predecessor closes its copy - successor accepts on the same socket */
+  ::close(listener);
+  OATPP_ASSERT(getPort(received) == port);
+
+  data::v_io_handle client = socket(AF_INET, SOCK_STREAM, 0);
+  OATPP_ASSERT(client >= 0);
+  addr.sin_port = htons(port);
+  OATPP_ASSERT(connect(client, (struct sockaddr*) &addr, sizeof(addr)) == 0);
+
+  data::v_io_handle accepted = accept(received, nullptr, nullptr);
+  OATPP_ASSERT(accepted >= 0);
+
+  ::close(accepted);
+  ::close(client);
+  ::close(received);
+
+}
+
+}}}
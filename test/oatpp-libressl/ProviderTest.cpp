@@ -0,0 +1,281 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ProviderTest.hpp"
+
+#include "oatpp-libressl/client/ConnectionProvider.hpp"
+#include "oatpp-libressl/server/ConnectionProvider.hpp"
+
+#include "oatpp-libressl/ListenerHandoff.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/MemoryPipe.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::MemoryPipe MemoryPipe;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+  const v_int64 HANDOFF_TIMEOUT_MICROS = 5 * 1000 * 1000;
+
+  v_word16 getListenerPort(data::v_io_handle handle) {
+    struct sockaddr_in6 address;
+    socklen_t length = sizeof(address);
+    std::memset(&address, 0, sizeof(address));
+    if(getsockname(handle, (struct sockaddr*) &address, &length) != 0 || address.sin6_family != AF_INET6) {
+      return 0;
+    }
+    return ntohs(address.sin6_port);
+  }
+
+  /* gives away one stream */
+  template<class Base>
+  class OneStreamProvider : public Base {
+  private:
+    std::shared_ptr<oatpp::data::stream::IOStream> m_stream;
+  public:
+
+    OneStreamProvider(const std::shared_ptr<oatpp::data::stream::IOStream>& stream)
+      : m_stream(stream)
+    {
+      this->setProperty(oatpp::network::ConnectionProvider::PROPERTY_HOST, "localhost");
+      this->setProperty(oatpp::network::ConnectionProvider::PROPERTY_PORT, "0");
+    }
+
+    std::shared_ptr<oatpp::data::stream::IOStream> getConnection() override {
+      auto stream = m_stream;
+      m_stream.reset();
+      return stream;
+    }
+
+    oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream>&> getConnectionAsync() override {
+      throw std::runtime_error("[oatpp::test::libressl::ProviderTest::OneStreamProvider::getConnectionAsync()]: Not implemented");
+    }
+
+    void close() override {
+      m_stream.reset();
+    }
+
+  };
+
+  /* both ends are driven from one thread - handshake is completed step by step */
+  void handshake(const std::shared_ptr<Connection>& server, const std::shared_ptr<Connection>& client) {
+    data::v_io_size clientResult;
+    data::v_io_size serverResult;
+    do {
+      clientResult = client->handshake();
+      serverResult = server->handshake();
+      OATPP_ASSERT(clientResult == 0 || clientResult == data::IOError::WAIT_RETRY);
+      OATPP_ASSERT(serverResult == 0 || serverResult == data::IOError::WAIT_RETRY);
+    } while(clientResult != 0 || serverResult != 0);
+  }
+
+  void checkExchange(oatpp::data::stream::IOStream* from, oatpp::data::stream::IOStream* to) {
+    const char* message = "ping";
+    v_char8 buffer[4];
+    OATPP_ASSERT(Utils::writeExactly(from, message, 4));
+    OATPP_ASSERT(Utils::readExactly(to, buffer, 4));
+    OATPP_ASSERT(std::memcmp(buffer, message, 4) == 0);
+  }
+
+  /* blocking server echoes one message back */
+  void checkEcho(const std::shared_ptr<oatpp::libressl::server::ConnectionProvider>& serverProvider,
+                 const std::shared_ptr<oatpp::libressl::client::ConnectionProvider>& clientProvider)
+  {
+
+    std::thread serverThread([serverProvider]{
+      auto connection = serverProvider->getConnection();
+      OATPP_ASSERT(connection);
+      v_char8 buffer[4];
+      OATPP_ASSERT(Utils::readExactly(connection.get(), buffer, 4));
+      OATPP_ASSERT(Utils::writeExactly(connection.get(), buffer, 4));
+    });
+
+    auto connection = clientProvider->getConnection();
+    OATPP_ASSERT(connection);
+
+    const char* message = "ping";
+    v_char8 buffer[4];
+    OATPP_ASSERT(Utils::writeExactly(connection.get(), message, 4));
+    OATPP_ASSERT(Utils::readExactly(connection.get(), buffer, 4));
+    OATPP_ASSERT(std::memcmp(buffer, message, 4) == 0);
+
+    serverThread.join();
+
+  }
+
+}
+
+void ProviderTest::onRun() {
+
+  /* close_notify may be written to the socket which peer has already closed */
+  signal(SIGPIPE, SIG_IGN);
+
+  auto keyPair = KeyPair::generate("localhost");
+  auto serverConfig = keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  {
+    OATPP_LOGD(TAG, "TLS over streams of other providers...");
+
+    std::shared_ptr<MemoryPipe::Endpoint> serverStream;
+    std::shared_ptr<MemoryPipe::Endpoint> clientStream;
+    MemoryPipe::createPair(serverStream, clientStream);
+
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(
+      serverConfig, std::make_shared<OneStreamProvider<oatpp::network::ServerConnectionProvider>>(serverStream));
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(
+      clientConfig, std::make_shared<OneStreamProvider<oatpp::network::ClientConnectionProvider>>(clientStream), "localhost");
+
+    auto server = std::static_pointer_cast<Connection>(serverProvider->getConnection());
+    auto client = std::static_pointer_cast<Connection>(clientProvider->getConnection());
+    OATPP_ASSERT(server && client);
+    OATPP_ASSERT(server->getStream() == serverStream);
+    OATPP_ASSERT(client->getStream() == clientStream);
+    OATPP_ASSERT(server->getHandle() == -1);
+
+    handshake(server, client);
+
+    /* SNI is passed by tls_connect_cbs() */
+    OATPP_ASSERT(server->getTlsInfo()->serverName->std_str() == "localhost");
+
+    checkExchange(client.get(), server.get());
+    checkExchange(server.get(), client.get());
+
+    /* stream provider is drained */
+    OATPP_ASSERT(!serverProvider->getConnection());
+    OATPP_ASSERT(!clientProvider->getConnection());
+  }
+
+  {
+    OATPP_LOGD(TAG, "IPv4 client to dual-stack listener...");
+
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, 0);
+
+    v_word16 port = getListenerPort(serverProvider->getListenerHandle());
+    OATPP_ASSERT(port != 0);
+
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, "127.0.0.1", port);
+    checkEcho(serverProvider, clientProvider);
+
+    serverProvider->close();
+  }
+
+  {
+    OATPP_LOGD(TAG, "unix domain socket...");
+
+    oatpp::String path = ("/tmp/oatpp-libressl-ProviderTest-" + std::to_string(getpid()) + ".sock").c_str();
+
+    auto serverProvider = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, path);
+    OATPP_ASSERT(access(path->c_str(), F_OK) == 0);
+
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, path, "localhost");
+    checkEcho(serverProvider, clientProvider);
+
+    /* socket file is removed on close */
+    serverProvider->close();
+    OATPP_ASSERT(access(path->c_str(), F_OK) != 0);
+  }
+
+
+  {
+    OATPP_LOGD(TAG, "export listener to successor...");
+
+    oatpp::String handoffPath = ("/tmp/oatpp-libressl-ProviderTest-" + std::to_string(getpid()) + ".handoff").c_str();
+
+    auto predecessor = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, 0);
+    OATPP_ASSERT((fcntl(predecessor->getListenerHandle(), F_GETFL) & O_NONBLOCK) != 0);
+
+    v_word16 port = getListenerPort(predecessor->getListenerHandle());
+    OATPP_ASSERT(port != 0);
+
+    /* acceptor blocked in getConnection() - as in server loop */
+    std::atomic<bool> acceptorDone(false);
+    std::shared_ptr<oatpp::data::stream::IOStream> accepted;
+    std::thread acceptor([predecessor, &accepted, &acceptorDone]{
+      accepted = predecessor->getConnection();
+      acceptorDone = true;
+    });
+
+    std::atomic<bool> exported(false);
+    std::thread exporter([predecessor, handoffPath, &exported]{
+      exported = predecessor->exportListener(handoffPath, HANDOFF_TIMEOUT_MICROS);
+    });
+
+    /* successor retries until predecessor listens on the handoff path */
+    data::v_io_handle handle = -1;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(HANDOFF_TIMEOUT_MICROS);
+    while(handle < 0 && std::chrono::steady_clock::now() < deadline) {
+      handle = oatpp::libressl::ListenerHandoff::receive(handoffPath, HANDOFF_TIMEOUT_MICROS);
+      if(handle < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+
+    exporter.join();
+    OATPP_ASSERT(exported);
+    OATPP_ASSERT(handle >= 0);
+
+    oatpp::libressl::server::ConnectionProvider::InheritedListener listener;
+    listener.handle = handle;
+    auto successor = oatpp::libressl::server::ConnectionProvider::createShared(serverConfig, listener);
+    OATPP_ASSERT(successor->getProperty(oatpp::network::ConnectionProvider::PROPERTY_PORT)->std_str() == std::to_string(port));
+
+    /* exported predecessor doesn't take connections - successor gets them */
+    auto clientProvider = oatpp::libressl::client::ConnectionProvider::createShared(clientConfig, "127.0.0.1", port);
+    checkEcho(successor, clientProvider);
+
+    /* acceptor keeps blocking - it doesn't spin on nullptr - until predecessor is closed */
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    OATPP_ASSERT(!acceptorDone);
+
+    predecessor->close();
+    acceptor.join();
+    OATPP_ASSERT(!accepted);
+
+    /* closing predecessor doesn't affect successor's listener */
+    checkEcho(successor, clientProvider);
+
+    successor->close();
+  }
+
+}
+
+}}}
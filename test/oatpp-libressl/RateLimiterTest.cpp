@@ -0,0 +1,59 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "RateLimiterTest.hpp"
+
+#include "oatpp-libressl/RateLimiter.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace oatpp { namespace test { namespace libressl {
+
+void RateLimiterTest::onRun() {
+
+  auto limiter = oatpp::libressl::RateLimiter::createShared(1024 * 1024, 16 * 1024);
+
+  /* full bucket - burst is granted at once, then bucket is empty */
+  OATPP_ASSERT(limiter->acquire(64 * 1024) == 16 * 1024);
+  OATPP_ASSERT(limiter->acquire(1) <= 1);
+
+  /* unused tokens are returned */
+  limiter->refund(1000);
+  OATPP_ASSERT(limiter->acquire(1000) == 1000);
+
+  /* bucket refills at rate, never above burst */
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  v_int64 granted = limiter->acquire(64 * 1024);
+  OATPP_ASSERT(granted > 0 && granted <= 16 * 1024);
+
+  limiter->onThrottled(100);
+  limiter->onThrottled(200);
+  OATPP_ASSERT(limiter->getThrottledCount() == 2);
+  OATPP_ASSERT(limiter->getThrottledMicros() == 300);
+
+}
+
+}}}
@@ -0,0 +1,180 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RelayTest.hpp"
+
+#include "oatpp-libressl/Relay.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <thread>
+#include <vector>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::libressl::Relay Relay;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+  /* plain backend stream over socket */
+  class SocketStream : public oatpp::data::stream::IOStream {
+  private:
+    int m_handle;
+  public:
+
+    SocketStream(int handle)
+      : m_handle(handle)
+    {}
+
+    data::v_io_size write(const void *buff, data::v_io_size count) override {
+      auto result = ::send(m_handle, buff, count, MSG_NOSIGNAL);
+      if(result < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? data::IOError::WAIT_RETRY : data::IOError::BROKEN_PIPE;
+      }
+      return result;
+    }
+
+    data::v_io_size read(void *buff, data::v_io_size count) override {
+      auto result = ::read(m_handle, buff, count);
+      if(result < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? data::IOError::WAIT_RETRY : data::IOError::BROKEN_PIPE;
+      }
+      return result;
+    }
+
+  };
+
+  std::vector<v_char8> createData(v_int32 size, v_int32 seed) {
+    std::vector<v_char8> data(size);
+    for(v_int32 i = 0; i < size; i ++) {
+      data[i] = (v_char8) (i * seed);
+    }
+    return data;
+  }
+
+}
+
+void RelayTest::onRun() {
+
+  auto keyPair = KeyPair::generate("localhost");
+  auto serverConfig = keyPair.createServerConfig();
+  auto clientConfig = KeyPair::createClientConfig();
+
+  Connection::TLSHandle serverHandle = tls_server();
+  OATPP_ASSERT(tls_configure(serverHandle, serverConfig->getTLSConfig()) == 0);
+
+  int peerFds[2];
+  OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, peerFds) == 0);
+
+  Connection::TLSHandle serverConnectionHandle;
+  OATPP_ASSERT(tls_accept_socket(serverHandle, &serverConnectionHandle, peerFds[0]) == 0);
+  auto server = Connection::createShared(serverConnectionHandle, peerFds[0]);
+
+  Connection::TLSHandle clientHandle = tls_client();
+  OATPP_ASSERT(tls_configure(clientHandle, clientConfig->getTLSConfig()) == 0);
+  OATPP_ASSERT(tls_connect_socket(clientHandle, peerFds[1], "localhost") == 0);
+  auto client = Connection::createShared(clientHandle, peerFds[1]);
+
+  /* non-blocking backend - relay has to wait for it without a handle to poll */
+  int backendFds[2];
+  OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, backendFds) == 0);
+  fcntl(backendFds[0], F_SETFL, O_NONBLOCK);
+  auto backend = std::make_shared<SocketStream>(backendFds[0]);
+
+  auto stats = std::make_shared<Relay::Stats>();
+
+  std::thread relayThread([&server, &backend, &stats, &backendFds] {
+    Relay::relay(server, backend, stats,
+                 [&backendFds] { ::shutdown(backendFds[0], SHUT_WR); },
+                 4096,
+                 [&backendFds] { ::shutdown(backendFds[0], SHUT_RDWR); });
+  });
+
+  auto request = createData(100 * 1024, 3);
+  auto response = createData(50 * 1024, 5);
+
+  /* backend replies when it sees the end of the request */
+  std::vector<v_char8> atBackend;
+  std::thread backendThread([&backendFds, &atBackend, &response] {
+    v_char8 buffer[4096];
+    ssize_t result;
+    while((result = ::read(backendFds[1], buffer, sizeof(buffer))) > 0) {
+      atBackend.insert(atBackend.end(), buffer, buffer + result);
+    }
+    size_t position = 0;
+    while(position < response.size()) {
+      result = ::send(backendFds[1], &response[position], response.size() - position, MSG_NOSIGNAL);
+      if(result <= 0) {
+        break;
+      }
+      position += result;
+    }
+    ::shutdown(backendFds[1], SHUT_WR);
+  });
+
+  OATPP_ASSERT(Utils::writeExactly(client.get(), request.data(), request.size()));
+  OATPP_ASSERT(client->closeWrite() == 0);
+
+  /* relay sends close_notify when the backend finishes */
+  std::vector<v_char8> atClient;
+  v_char8 buffer[4096];
+  while(true) {
+    auto result = client->read(buffer, sizeof(buffer));
+    if(result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY) {
+      continue;
+    }
+    if(result <= 0) {
+      OATPP_ASSERT(result == 0);
+      break;
+    }
+    atClient.insert(atClient.end(), buffer, buffer + result);
+  }
+
+  backendThread.join();
+  relayThread.join();
+
+  OATPP_ASSERT(atBackend == request);
+  OATPP_ASSERT(atClient == response);
+
+  OATPP_ASSERT(stats->bytesToBackend == (v_int64) request.size());
+  OATPP_ASSERT(stats->bytesToPeer == (v_int64) response.size());
+  OATPP_ASSERT(stats->relaysFinished == 1);
+
+  ::close(backendFds[0]);
+  ::close(backendFds[1]);
+
+  tls_free(serverHandle);
+
+}
+
+}}}
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "SessionStoreTest.hpp"
+
+#include "oatpp-libressl/Config.hpp"
+#include "oatpp-libressl/SessionStore.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Config Config;
+  typedef oatpp::libressl::SessionStore SessionStore;
+
+}
+
+void SessionStoreTest::onRun() {
+
+  std::string name = "/oatpp-libressl-SessionStoreTest-" + std::to_string(getpid());
+  SessionStore::unlink(name.c_str());
+
+  v_int64 createdAt = (v_int64) std::time(nullptr);
+
+  /* two workers opening the same store - the second one finds keys of the first */
+  auto first = SessionStore::createShared(name.c_str(), 2);
+  auto second = SessionStore::createShared(name.c_str(), 1000);
+
+  OATPP_ASSERT(first->getLifetime() == 2);
+  OATPP_ASSERT(second->getLifetime() == 2);
+  OATPP_ASSERT(first->getKeyRevision() == 1);
+  OATPP_ASSERT(second->getKeyRevision() == 1);
+
+  auto firstConfig = Config::createShared();
+  auto secondConfig = Config::createShared();
+  auto firstKeys = first->configure(firstConfig->getTLSConfig());
+  auto secondKeys = second->configure(secondConfig->getTLSConfig());
+
+  /* keys rotate every lifetime / 2 seconds */
+  while((v_int64) std::time(nullptr) < createdAt + 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  /* whichever worker notices first rotates - the other one sees the new key */
+  second->sync(*secondKeys);
+  OATPP_ASSERT(second->getKeyRevision() == 2);
+  OATPP_ASSERT(first->getKeyRevision() == 2);
+
+  /* already rotated - nothing to do for the first worker but to pick up the key */
+  first->sync(*firstKeys);
+  OATPP_ASSERT(first->getKeyRevision() == 2);
+
+  SessionStore::unlink(name.c_str());
+
+}
+
+}}}
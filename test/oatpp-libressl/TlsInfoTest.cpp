@@ -0,0 +1,153 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "TlsInfoTest.hpp"
+
+#include "oatpp-libressl/KeyPair.hpp"
+#include "oatpp-libressl/MemoryPipe.hpp"
+#include "oatpp-libressl/Utils.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::Connection Connection;
+  typedef oatpp::benchmark::libressl::KeyPair KeyPair;
+  typedef oatpp::benchmark::libressl::MemoryPipe MemoryPipe;
+  typedef oatpp::benchmark::libressl::Utils Utils;
+
+}
+
+void TlsInfoTest::onRun() {
+
+  auto keyPair = KeyPair::generate("localhost");
+  auto serverConfig = keyPair.createServerConfig();
+
+  Connection::TLSHandle serverHandle = tls_server();
+  OATPP_ASSERT(tls_configure(serverHandle, serverConfig->getTLSConfig()) == 0);
+
+  {
+    OATPP_LOGD(TAG, "negotiated parameters...");
+
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    OATPP_ASSERT(Utils::createMemoryPair(serverHandle, KeyPair::createClientConfig(), server, client));
+
+    auto serverInfo = server->getTlsInfo();
+    auto clientInfo = client->getTlsInfo();
+    OATPP_ASSERT(serverInfo);
+    OATPP_ASSERT(clientInfo);
+
+    /* values are cached */
+    OATPP_ASSERT(server->getTlsInfo() == serverInfo);
+
+    OATPP_ASSERT(serverInfo->version && clientInfo->version);
+    OATPP_ASSERT(serverInfo->version->std_str() == clientInfo->version->std_str());
+    OATPP_ASSERT(serverInfo->cipher && serverInfo->cipher->std_str() == clientInfo->cipher->std_str());
+    OATPP_ASSERT(serverInfo->cipherStrength > 0);
+    OATPP_ASSERT(!serverInfo->sessionResumed);
+
+    /* no ALPN configured */
+    OATPP_ASSERT(!serverInfo->alpn);
+    OATPP_ASSERT(!server->getAlpnProtocol());
+
+    /* SNI sent by the client */
+    OATPP_ASSERT(serverInfo->serverName && serverInfo->serverName->std_str() == "localhost");
+
+    /* client sent no certificate */
+    OATPP_ASSERT(!serverInfo->peerCertHash);
+    OATPP_ASSERT(!serverInfo->peerCertSubject);
+
+    OATPP_ASSERT(clientInfo->peerCertHash);
+    OATPP_ASSERT(clientInfo->peerCertHash->std_str().compare(0, 7, "SHA256:") == 0);
+    OATPP_ASSERT(clientInfo->peerCertSubject);
+    OATPP_ASSERT(clientInfo->peerCertSubject->std_str().find("localhost") != std::string::npos);
+
+    OATPP_ASSERT(!server->getLastError());
+    OATPP_ASSERT(!client->getLastError());
+  }
+
+  {
+    OATPP_LOGD(TAG, "handshake time doesn't include time before the first handshake step...");
+
+    std::shared_ptr<MemoryPipe::Endpoint> serverStream;
+    std::shared_ptr<MemoryPipe::Endpoint> clientStream;
+    MemoryPipe::createPair(serverStream, clientStream);
+
+    Connection::TLSHandle serverConnectionHandle;
+    OATPP_ASSERT(tls_accept_cbs(serverHandle, &serverConnectionHandle, Connection::readCallback, Connection::writeCallback, serverStream.get()) == 0);
+    auto server = Connection::createShared(serverConnectionHandle, serverStream);
+
+    auto clientConfig = KeyPair::createClientConfig();
+    Connection::TLSHandle clientHandle = tls_client();
+    OATPP_ASSERT(tls_configure(clientHandle, clientConfig->getTLSConfig()) == 0);
+    OATPP_ASSERT(tls_connect_cbs(clientHandle, Connection::readCallback, Connection::writeCallback, clientStream.get(), "localhost") == 0);
+    auto client = Connection::createShared(clientHandle, clientStream);
+
+    OATPP_ASSERT(!server->getTlsInfo());
+    OATPP_ASSERT(!client->getTlsInfo());
+
+    /* connection waits in the queue */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    v_int64 startedAt = oatpp::base::Environment::getMicroTickCount();
+    data::v_io_size clientResult;
+    data::v_io_size serverResult;
+    do {
+      clientResult = client->handshake();
+      serverResult = server->handshake();
+      OATPP_ASSERT(clientResult == 0 || clientResult == data::IOError::WAIT_RETRY);
+      OATPP_ASSERT(serverResult == 0 || serverResult == data::IOError::WAIT_RETRY);
+    } while(clientResult != 0 || serverResult != 0);
+    v_int64 elapsed = oatpp::base::Environment::getMicroTickCount() - startedAt;
+
+    OATPP_ASSERT(server->getTlsInfo()->handshakeMicros >= 0);
+    OATPP_ASSERT(server->getTlsInfo()->handshakeMicros <= elapsed);
+    OATPP_ASSERT(client->getTlsInfo()->handshakeMicros <= elapsed);
+  }
+
+  {
+    OATPP_LOGD(TAG, "last error...");
+
+    /* default config verifies the certificate - self-signed certificate is rejected */
+    auto verifyingConfig = oatpp::libressl::Config::createShared();
+
+    std::shared_ptr<Connection> server;
+    std::shared_ptr<Connection> client;
+    OATPP_ASSERT(!Utils::createMemoryPair(serverHandle, verifyingConfig, server, client));
+
+    OATPP_ASSERT(client);
+    OATPP_ASSERT(!client->getTlsInfo());
+    OATPP_ASSERT(client->getLastError());
+    OATPP_LOGD(TAG, "client error: '%s'", client->getLastError()->c_str());
+  }
+
+  tls_free(serverHandle);
+
+}
+
+}}}
@@ -0,0 +1,103 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "TraceTest.hpp"
+
+#include "oatpp-libressl/Trace.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+v_int32 countOf(const std::string& text, const std::string& pattern) {
+  v_int32 count = 0;
+  for(auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+    count ++;
+  }
+  return count;
+}
+
+/* clear() drops events recorded before the call - wait until the last given tick is in the past */
+void clearAfter(v_int64 tick) {
+  while(oatpp::base::Environment::getMicroTickCount() <= tick) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  oatpp::libressl::Trace::clear();
+}
+
+}
+
+void TraceTest::onRun() {
+
+  typedef oatpp::libressl::Trace Trace;
+
+  /* ticks are given explicitly - durations don't depend on scheduling */
+  Trace::clear();
+  v_int64 base = oatpp::base::Environment::getMicroTickCount();
+
+  Trace::Span fast;
+  Trace::Span slow;
+
+  /* events are recorded once per span */
+  Trace::record(fast, Trace::ACCEPT, base);
+  Trace::record(fast, Trace::ACCEPT, base + 500);
+  Trace::record(slow, Trace::ACCEPT, base);
+  Trace::record(fast, Trace::HANDSHAKE_DONE, base + 1000);
+
+  /* span may move between threads */
+  std::thread thread([&slow, base]{
+    Trace::record(slow, Trace::HANDSHAKE_DONE, base + 20 * 1000);
+    Trace::record(slow, Trace::CLOSE, base + 21 * 1000);
+  });
+  thread.join();
+
+  auto all = Trace::exportChromeTrace()->std_str();
+  OATPP_ASSERT(countOf(all, "\"name\":\"accept\"") == 2);
+  OATPP_ASSERT(countOf(all, "\"name\":\"handshake\"") == 2);
+  OATPP_ASSERT(countOf(all, "\"name\":\"close\"") == 1);
+
+  auto outliers = Trace::exportChromeTrace(10 * 1000)->std_str();
+  OATPP_ASSERT(countOf(outliers, "\"name\":\"accept\"") == 1);
+  OATPP_ASSERT(countOf(outliers, "\"tid\":" + std::to_string(slow.id) + ",") == 5);
+
+  /* event taken before the span existed is recorded later with its own tick */
+  clearAfter(base + 21 * 1000);
+  base = oatpp::base::Environment::getMicroTickCount();
+  Trace::Span accepted;
+  Trace::record(accepted, Trace::HANDSHAKE_DONE, base + 20 * 1000);
+  Trace::record(accepted, Trace::ACCEPT, base);
+  auto delayed = Trace::exportChromeTrace(10 * 1000)->std_str();
+  OATPP_ASSERT(countOf(delayed, "\"name\":\"handshake\"") == 1);
+
+  clearAfter(base + 20 * 1000);
+  OATPP_ASSERT(countOf(Trace::exportChromeTrace()->std_str(), "\"ph\":") == 0);
+
+}
+
+}}}
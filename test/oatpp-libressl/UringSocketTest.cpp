@@ -0,0 +1,138 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+
+#include "UringSocketTest.hpp"
+
+#include "oatpp-libressl/uring/Socket.hpp"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+namespace oatpp { namespace test { namespace libressl {
+
+namespace {
+
+  typedef oatpp::libressl::uring::Ring Ring;
+  typedef oatpp::libressl::uring::Socket Socket;
+
+  const v_int32 PAIRS_COUNT = 6;
+  const v_int32 DATA_SIZE = 100000;
+
+  bool isRetry(data::v_io_size result) {
+    return result == data::IOError::WAIT_RETRY || result == data::IOError::RETRY;
+  }
+
+  void writeAll(Socket* socket, const v_char8* data, data::v_io_size size) {
+    data::v_io_size offset = 0;
+    while(offset < size) {
+      auto result = socket->write(&data[offset], size - offset);
+      if(isRetry(result)) {
+        continue;
+      }
+      OATPP_ASSERT(result > 0);
+      offset += result;
+    }
+  }
+
+  data::v_io_size readAll(Socket* socket, v_char8* buffer, data::v_io_size size) {
+    data::v_io_size offset = 0;
+    while(offset < size) {
+      auto result = socket->read(&buffer[offset], size - offset);
+      if(isRetry(result)) {
+        continue;
+      }
+      if(result <= 0) {
+        break;
+      }
+      offset += result;
+    }
+    return offset;
+  }
+
+  void runPair(const std::shared_ptr<Ring>& ring, bool blocking) {
+
+    int handles[2];
+    OATPP_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, handles) == 0);
+
+    auto writer = Socket::createShared(ring, handles[0], blocking);
+    auto reader = Socket::createShared(ring, handles[1], blocking);
+
+    std::vector<v_char8> data(DATA_SIZE);
+    for(v_int32 i = 0; i < DATA_SIZE; i ++) {
+      data[i] = (v_char8) (i * 7);
+    }
+
+    std::thread writerThread([writer, &data]{
+      writeAll(writer.get(), data.data(), data.size());
+      /* waits for write-behind - and reports whether the last write was sent */
+      OATPP_ASSERT(writer->close() == 0);
+    });
+
+    std::vector<v_char8> received(DATA_SIZE);
+    OATPP_ASSERT(readAll(reader.get(), received.data(), received.size()) == DATA_SIZE);
+    writerThread.join();
+    OATPP_ASSERT(std::memcmp(data.data(), received.data(), DATA_SIZE) == 0);
+
+    /* peer closed */
+    v_char8 byte;
+    OATPP_ASSERT(readAll(reader.get(), &byte, 1) == 0);
+    reader->close();
+
+  }
+
+  void runPairs(const std::shared_ptr<Ring>& ring, bool blocking) {
+    std::vector<std::thread> threads;
+    for(v_int32 i = 0; i < PAIRS_COUNT; i ++) {
+      threads.push_back(std::thread(runPair, ring, blocking));
+    }
+    for(auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+}
+
+void UringSocketTest::onRun() {
+
+  /* small submission queue and few registered buffers - queue gets full and some sockets use own buffers */
+  auto ring = Ring::createShared(8, 4, 4096, 4, 50);
+  OATPP_LOGD(TAG, "io_uring available=%d", (v_int32) ring->isAvailable());
+
+  runPairs(ring, true);
+  runPairs(ring, false);
+
+  /* recv()/send() fallback */
+  runPairs(nullptr, true);
+  runPairs(nullptr, false);
+
+  if(ring->isAvailable()) {
+    OATPP_ASSERT(ring->getSubmittedCount() > 0);
+  }
+
+}
+
+}}}
@@ -1,6 +1,19 @@
 
 #include "oatpp-test/UnitTest.hpp"
 
+#include "oatpp-libressl/ConfigTest.hpp"
+#include "oatpp-libressl/ConnectionReserveTest.hpp"
+#include "oatpp-libressl/ConnectionTest.hpp"
+#include "oatpp-libressl/ErrorStatsTest.hpp"
+#include "oatpp-libressl/ListenerHandoffTest.hpp"
+#include "oatpp-libressl/ProviderTest.hpp"
+#include "oatpp-libressl/RateLimiterTest.hpp"
+#include "oatpp-libressl/RelayTest.hpp"
+#include "oatpp-libressl/SessionStoreTest.hpp"
+#include "oatpp-libressl/TlsInfoTest.hpp"
+#include "oatpp-libressl/TraceTest.hpp"
+#include "oatpp-libressl/UringSocketTest.hpp"
+
 #include "oatpp-libressl/Callbacks.hpp"
 
 #include "oatpp/core/concurrency/SpinLock.hpp"
@@ -26,22 +39,23 @@ public:
 
 };
 
-class Test : public oatpp::test::UnitTest {
-public:
-  Test() : oatpp::test::UnitTest("MyTag")
-  {}
-
-  void onRun() override {
-    // TODO write correct  tests
-  }
-};
-
 void runTests() {
 
   /* set lockingCallback for libressl */
   oatpp::libressl::Callbacks::setDefaultCallbacks();
 
-  OATPP_RUN_TEST(Test);
+  OATPP_RUN_TEST(oatpp::test::libressl::ConfigTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::ConnectionReserveTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::ConnectionTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::ErrorStatsTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::ListenerHandoffTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::ProviderTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::RateLimiterTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::RelayTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::SessionStoreTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::TlsInfoTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::TraceTest);
+  OATPP_RUN_TEST(oatpp::test::libressl::UringSocketTest);
 
 }
 